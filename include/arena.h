@@ -0,0 +1,67 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <memory_resource>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+// Monotonic arena for the temporaries of one fold job (split matrices,
+// population arenas, network parameters). Deallocation is a no-op; reset()
+// rewinds the whole arena at once. If a fold spilled past the initial
+// block, reset() grows the block to the observed peak, so after the first
+// few folds every job runs out of one reused block with no malloc/free.
+class FoldArena {
+private:
+    // Upstream that counts the bytes requested beyond the initial block
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        size_t bytes_allocated;
+        
+        CountingResource() : bytes_allocated(0) {}
+        
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+    
+    std::unique_ptr<std::byte[]> block;
+    size_t block_size;
+    CountingResource upstream;
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> monotonic;
+    int resets;
+    int regrowths;
+    
+    void rebuild();
+    
+public:
+    explicit FoldArena(size_t initial_bytes = 1 << 20);
+    FoldArena(const FoldArena&) = delete;
+    FoldArena& operator=(const FoldArena&) = delete;
+    
+    std::pmr::memory_resource* resource() { return monotonic.get(); }
+    
+    // Rewind the arena; every object allocated from it must be gone
+    void reset();
+    
+    size_t capacity() const { return block_size; }
+    int getResets() const { return resets; }
+    int getRegrowths() const { return regrowths; }
+};
+
+// One arena per pool worker so fold jobs never share an allocator
+class ArenaPool {
+private:
+    std::vector<std::unique_ptr<FoldArena>> arenas;
+    
+public:
+    ArenaPool(int num_workers, size_t initial_bytes = 1 << 20);
+    
+    FoldArena& forWorker(int worker_id) { return *arenas[worker_id]; }
+    int size() const { return static_cast<int>(arenas.size()); }
+};
+
+#endif // ARENA_H
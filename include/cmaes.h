@@ -0,0 +1,93 @@
+#ifndef CMAES_H
+#define CMAES_H
+
+#include <vector>
+#include <memory_resource>
+#include "optimizer.h"
+#include "utils.h"
+
+struct CMAESConfig {
+    int population_size;     // lambda (>= 2); 0 selects 4 + floor(3 ln n)
+    int max_generations;
+    double initial_sigma;
+    double initial_range;    // initial mean drawn from [-range, range]
+    bool verbose;
+    
+    // Default values
+    CMAESConfig()
+        : population_size(0),
+          max_generations(100),
+          initial_sigma(0.5),
+          initial_range(1.0),
+          verbose(true) {}
+};
+
+// Separable CMA-ES (Ros & Hansen, 2008): diagonal covariance, rank-mu and
+// rank-one updates with cumulative step-size adaptation. Fitness is
+// maximized. Sampling is done for the whole population in one batch.
+class SepCMAES : public Optimizer {
+private:
+    CMAESConfig config;
+    int lambda;
+    int mu;
+    
+    // Strategy parameters
+    std::vector<double> weights;
+    double mu_eff;
+    double c_sigma;
+    double d_sigma;
+    double c_c;
+    double c_1;
+    double c_mu;
+    double chi_n;
+    
+    // Distribution state
+    std::pmr::vector<double> mean;
+    std::pmr::vector<double> diag_c;      // diagonal of C
+    std::pmr::vector<double> diag_d;      // sqrt(diag_c)
+    std::pmr::vector<double> p_sigma;
+    std::pmr::vector<double> p_c;
+    double sigma;
+    double batch_disagreement;           // of the last batch's predictions
+    
+    // Batched samples: lambda rows of length n
+    std::pmr::vector<double> z_samples;
+    std::pmr::vector<double> y_samples;
+    std::pmr::vector<double> x_samples;
+    std::pmr::vector<int> ranking;
+    std::pmr::vector<double> y_weighted;
+    std::pmr::vector<double> z_weighted;
+    std::pmr::vector<double> rank_mu_sum;
+    Utils::FastRandom fast_rng;
+    
+    void updateDistribution(const double* scores);
+    
+protected:
+    int maxGenerations() const override { return config.max_generations; }
+    void initializeState() override;
+    void processScores(const double* scores, const uint64_t* predictions) override;
+    
+    // Diversity of the sampling distribution (genotype) and of the last
+    // batch (predictions)
+    GenotypeDiversity genotypeDiversity() const override;
+    double phenotypeDiversity() const override { return batch_disagreement; }
+    
+    // Re-centre on the best so far with the initial step size, an
+    // identity covariance and fresh evolution paths (whose age, used by
+    // the h_sigma test, counts from the restart)
+    void restartPopulation() override;
+    
+public:
+    SepCMAES(int chrom_length, const CMAESConfig& cfg = CMAESConfig(),
+             std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    ~SepCMAES();
+    
+    int batchSize() const override { return lambda; }
+    const double* ask() override;
+    double diversity() const override;
+    std::string name() const override { return "Separable CMA-ES"; }
+    
+    double getSigma() const { return sigma; }
+};
+
+#endif // CMAES_H
@@ -10,6 +10,11 @@
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
+#include <memory_resource>
+#include "matrix.h"
+#include "feature_pipeline.h"
+#include "fold_plan.h"
+#include "numa.h"
 
 class Dataset {
 private:
@@ -23,7 +28,26 @@ private:
     int num_samples;
     int num_features;
     
-    std::vector<int> fold_indices; 
+    // Model inputs, one flat row per sample: the features after the
+    // preprocessing pipeline. Built once and read by every fold and thread.
+    FeatureMatrix inputs;
+    
+    // Stratified splits by (k, seed), shared by every run that uses them
+    mutable FoldPlanCache fold_plans;
+    
+    // Node-local copies of inputs and labels for NUMA node 1.. (node 0
+    // reads the originals); dropped whenever the inputs are rebuilt
+    struct InputReplica {
+        FeatureMatrix inputs;
+        std::vector<int> labels;
+    };
+    std::vector<std::unique_ptr<InputReplica>> replicas;
+    
+    // What node reads: its replica, or the originals for node 0 and
+    // nodes without one
+    const InputReplica* replicaFor(int node) const;
+    
+    void rebuildInputs();
     
 public:
     Dataset();
@@ -35,15 +59,39 @@ public:
     void normalizeWithStats(const std::vector<double>& means, 
                            const std::vector<double>& stds);
     
-    void createKFolds(int k = 10, unsigned int seed = 42);
-        void getTrainTestSplit(int test_fold, 
-                          std::vector<std::vector<double>>& train_X,
-                          std::vector<int>& train_y,
-                          std::vector<std::vector<double>>& test_X,
-                          std::vector<int>& test_y) const;
+    // Replace the cached inputs with pipeline(features). Apply after
+    // normalization: normalizing resets the inputs to the raw features.
+    void applyPipeline(const FeaturePipeline& pipeline);
+    
+    // Stratified k-fold split for seed, built once and cached; thread-safe,
+    // so runs with different seeds can split one read-only dataset at once
+    std::shared_ptr<const FoldPlan> getFoldPlan(int k, unsigned int seed, int node = 0) const;
+    
+    // The cached inputs at the given sample indices (e.g. a FoldPlan's
+    // train or test rows), without copying; with a node, its replica's
+    SampleView view(const std::vector<int>& rows, int node = 0) const;
+    
+    // Copy the inputs and labels to every other node of topology, each
+    // copy made by a thread bound to its node so first touch places it
+    // there. Call after preprocessing: rebuilding the inputs drops them.
+    void replicateInputs(const NumaTopology& topology);
+    int numReplicas() const { return static_cast<int>(replicas.size()) + 1; }
+    
+    // Per-fold input reduction: fit reducer on train_rows only, then write
+    // every sample through it into reduced (e.g. arena-backed). view() over
+    // reduced takes the same row indices. A normalization, when given, is
+    // applied on the fly inside the reducer (no normalized copy is made).
+    // With a node, the inputs and labels are read from its replica.
+    void reduceInputs(InputReducer& reducer, const std::vector<int>& train_rows,
+                      unsigned int seed, const InputNormalization* normalization,
+                      FeatureMatrix& reduced, int node = 0) const;
+    SampleView view(const FeatureMatrix& reduced, const std::vector<int>& rows,
+                    int node = 0) const;
     
     int getNumSamples() const { return num_samples; }
     int getNumFeatures() const { return num_features; }
+    int getInputWidth() const { return inputs.cols; }
+    const FeatureMatrix& getInputs() const { return inputs; }
     const std::vector<std::vector<double>>& getFeatures() const { return features; }
     const std::vector<int>& getLabels() const { return labels; }
     const std::vector<double>& getFeatureMeans() const { return feature_means; }
@@ -0,0 +1,132 @@
+#ifndef FEATURE_PIPELINE_H
+#define FEATURE_PIPELINE_H
+
+#include <vector>
+#include <string>
+#include "matrix.h"
+#include "json.h"
+
+enum class FeatureStageType {
+    STANDARDIZE,    // z-score every column (population std, 1 if constant)
+    SQUARES,        // append x_i^2
+    INTERACTIONS,   // append x_i * x_j for i < j
+    PCA             // project onto the top principal components
+};
+
+FeatureStageType parseFeatureStageType(const std::string& name);
+std::string featureStageTypeName(FeatureStageType type);
+
+struct FeatureStage {
+    FeatureStageType type;
+    int components;  // PCA output width
+
+    FeatureStage() : type(FeatureStageType::STANDARDIZE), components(10) {}
+};
+
+struct InputNormalization;
+
+// Principal axes of a sample matrix, fitted by cyclic Jacobi on the
+// covariance; project() maps a row onto the first components
+struct PCAProjection {
+    std::vector<double> mean;                 // [input]
+    std::vector<std::vector<double>> axes;    // [component][input], by variance
+    std::vector<double> variances;            // [component]
+
+    // With a normalization the axes are fitted on the z-scored rows (one
+    // row of scratch at a time) and then folded back, so project() takes
+    // raw rows
+    static PCAProjection fit(const SampleView& X, int components,
+                             const InputNormalization* normalization = nullptr);
+    void project(const double* row, double* out) const;
+    int outputWidth() const { return static_cast<int>(axes.size()); }
+};
+
+// Fixed (label-free) preprocessing applied once to the whole dataset. The
+// output is cached by Dataset as one flat matrix that every fold and
+// thread reads, instead of each fold recomputing features. Stages that
+// fit statistics (standardize, PCA) see all samples, test folds included,
+// exactly like the global normalization that precedes the pipeline; with
+// per-fold normalization such stages are rejected (SweepSpec::validate).
+class FeaturePipeline {
+private:
+    std::vector<FeatureStage> stages;
+
+public:
+    FeaturePipeline() {}
+
+    // [{"stage": "interactions"}, {"stage": "pca", "components": 10}, ...]
+    static FeaturePipeline fromJSON(const JsonValue& json);
+
+    bool empty() const { return stages.empty(); }
+    bool fitsStatistics() const;   // any standardize or PCA stage
+    int outputWidth(int input_width) const;
+    FeatureMatrix apply(const FeatureMatrix& input) const;
+    std::string describe() const;
+};
+
+// Z-score statistics of one training fold (population std, 1 if constant).
+// Applied lazily: MLP::setInputNormalization folds them into the first
+// layer, so fold-correct normalization never copies the dataset.
+struct InputNormalization {
+    std::vector<double> mean;
+    std::vector<double> inv_std;
+
+    // One pass over the view's rows (shifted sums for stability)
+    static InputNormalization fit(const SampleView& train);
+    void apply(const double* row, double* out) const;
+    bool empty() const { return mean.empty(); }
+};
+
+enum class ReductionMethod {
+    NONE,
+    PCA,            // per-fold principal components
+    FEATURE_MASK    // per-fold subset of inputs chosen by a small GA
+};
+
+ReductionMethod parseReductionMethod(const std::string& name);
+std::string reductionMethodName(ReductionMethod method);
+
+struct InputReductionConfig {
+    ReductionMethod method;
+    int components;          // reduced input width
+    int mask_population;     // feature-mask GA
+    int mask_generations;
+
+    InputReductionConfig()
+        : method(ReductionMethod::NONE),
+          components(10),
+          mask_population(20),
+          mask_generations(30) {}
+};
+
+// Shrinks the inputs of one fold to config.components columns. Fitted on
+// the training fold only, so nothing about the test samples leaks into the
+// projection. The feature mask is scored by a nearest-centroid classifier
+// on the training fold, a cheap stand-in for the network.
+class InputReducer {
+private:
+    InputReductionConfig config;
+    PCAProjection pca;
+    std::vector<int> mask;           // selected input columns, ascending
+    std::vector<double> mask_mean;   // [selected] z-score of the selected columns
+    std::vector<double> mask_scale;  // (0 and 1 without a normalization)
+
+    void fitMask(const SampleView& train, unsigned int seed,
+                 const InputNormalization* normalization);
+
+public:
+    explicit InputReducer(const InputReductionConfig& cfg) : config(cfg) {}
+
+    // normalization, if given, is the fold's z-scoring: the reducer is
+    // fitted as if the rows were normalized and transform() applies it
+    // on the fly, so no normalized copy of the inputs is made
+    void fit(const SampleView& train, unsigned int seed,
+             const InputNormalization* normalization = nullptr);
+    void transform(const double* row, double* out) const;
+    int outputWidth() const { return config.components; }
+
+    // "pca10" or the selected input columns joined with ';'
+    std::string describe() const;
+};
+
+#endif // FEATURE_PIPELINE_H
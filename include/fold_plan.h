@@ -0,0 +1,49 @@
+#ifndef FOLD_PLAN_H
+#define FOLD_PLAN_H
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+// Immutable stratified k-fold split. Each class is shuffled with the seed
+// and dealt round-robin over the folds (continuing where the previous
+// class stopped), so every fold keeps the class ratio and fold sizes
+// differ by at most one. Train/test rows are precomputed and ascending;
+// a plan never changes, so any number of threads may read it.
+class FoldPlan {
+private:
+    int k;
+    unsigned int seed;
+    std::vector<int> assignment;               // [sample] fold
+    std::vector<std::vector<int>> train_rows;  // [fold] ascending sample indices
+    std::vector<std::vector<int>> test_rows;   // [fold]
+
+public:
+    FoldPlan(const std::vector<int>& labels, int num_folds, unsigned int split_seed);
+
+    int numFolds() const { return k; }
+    unsigned int getSeed() const { return seed; }
+    const std::vector<int>& assignments() const { return assignment; }
+    const std::vector<int>& trainRows(int fold) const { return train_rows[fold]; }
+    const std::vector<int>& testRows(int fold) const { return test_rows[fold]; }
+};
+
+// Plans of one label vector keyed by (k, seed, NUMA node), built on first
+// use and shared from then on. Each node's copy is built by the first
+// thread asking for it there, so first touch keeps its arrays node-local.
+// Thread-safe.
+class FoldPlanCache {
+private:
+    std::map<std::tuple<int, unsigned int, int>, std::shared_ptr<const FoldPlan>> plans;
+    mutable std::mutex mutex;
+
+public:
+    std::shared_ptr<const FoldPlan> get(const std::vector<int>& labels, int k, unsigned int seed,
+                                        int node = 0);
+    void clear();
+    size_t size() const;
+};
+
+#endif // FOLD_PLAN_H
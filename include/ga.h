@@ -3,15 +3,13 @@
 
 #include <vector>
 #include <functional>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
 #include "mlp.h"
-
-struct Individual {
-    std::vector<double> chromosome;
-    double fitness;
-    
-    Individual() : fitness(0.0) {}
-    Individual(int size) : chromosome(size), fitness(0.0) {}
-};
+#include "mutation.h"
+#include "optimizer.h"
+#include "utils.h"
 
 struct GAConfig {
     int population_size;
@@ -19,8 +17,13 @@ struct GAConfig {
     double crossover_rate;
     double mutation_rate;
     double mutation_strength;
+    MutationType mutation_type;
+    double min_step_size;
     double elitism_rate;
     int tournament_size;
+    int local_search_elites;     // best individuals refined per generation (0 = off)
+    int local_search_steps;      // gradient steps per refinement
+    double local_search_rate;    // gradient step size
     bool verbose;
     
     // Default values
@@ -30,66 +33,109 @@ struct GAConfig {
           crossover_rate(0.8),
           mutation_rate(0.1),
           mutation_strength(0.3),
+          mutation_type(MutationType::GAUSSIAN),
+          min_step_size(1e-4),
           elitism_rate(0.1),
           tournament_size(3),
+          local_search_elites(0),
+          local_search_steps(5),
+          local_search_rate(0.5),
           verbose(true) {}
 };
 
-class GeneticAlgorithm {
+class GeneticAlgorithm : public Optimizer {
 private:
     GAConfig config;
-    std::vector<Individual> population;
-    int chromosome_length;
-    double best_fitness;
-    Individual best_individual;
+    bool initial_batch;
     
-    // Fitness function (external)
-    std::function<double(const std::vector<double>&)> fitness_function;
+    // Population arena: individual i occupies
+    // genes[i * chromosome_length, (i + 1) * chromosome_length)
+    std::pmr::vector<double> genes;
+    std::pmr::vector<double> fitness;
+    std::pmr::vector<double> offspring_genes;
+    std::pmr::vector<double> offspring_fitness;
+    std::pmr::vector<double> next_genes;
+    std::pmr::vector<double> next_fitness;
+    double fitness_sum;          // of fitness, kept by replacePopulation
     
-    // GA operations
-    void initializePopulation(double min_val = -1.0, double max_val = 1.0);
-    void evaluateFitness();
-    Individual tournamentSelection();
-    std::pair<Individual, Individual> crossover(const Individual& parent1, 
-                                                const Individual& parent2);
-    void mutate(Individual& individual);
-    void replacePopulation(std::vector<Individual>& offspring);
+    // Prediction bitsets (predictionWords() per individual), moved with
+    // the individuals like the fitness when phenotypes are tracked
+    std::pmr::vector<uint64_t> phenotypes;
+    std::pmr::vector<uint64_t> offspring_phenotypes;
+    std::pmr::vector<uint64_t> next_phenotypes;
     
-    // Statistics
-    std::vector<double> fitness_history;
-    std::vector<double> best_fitness_history;
-    std::vector<double> avg_fitness_history;
+    // Per-gene sum and sum of squares over the population, accumulated
+    // while replacePopulation copies the survivors in
+    std::pmr::vector<double> gene_sum;
+    std::pmr::vector<double> gene_sum_sq;
     
-public:
-    GeneticAlgorithm(int chrom_length, const GAConfig& cfg = GAConfig());
-    ~GeneticAlgorithm();
+    // Bulk operator buffers, reused every generation
+    std::pmr::vector<int> parent_indices;
+    std::pmr::vector<int> population_order;
+    std::pmr::vector<int> offspring_order;
+    std::pmr::vector<uint8_t> crossover_mask;
+    Utils::FastRandom fast_rng;
     
-    // Set fitness function
-    void setFitnessFunction(std::function<double(const std::vector<double>&)> func);
+    // Mutation operator; self-adaptive operators also carry per-gene step
+    // sizes laid out exactly like the gene arenas
+    std::unique_ptr<MutationOperator> mutation_operator;
+    std::pmr::vector<double> step_sizes;
+    std::pmr::vector<double> offspring_step_sizes;
+    std::pmr::vector<double> next_step_sizes;
     
-    // Run GA
-    void evolve();
+    // Lamarckian refinement buffers
+    std::pmr::vector<double> refine_genes;
+    std::pmr::vector<double> refine_scores;
+    std::pmr::vector<uint64_t> refine_phenotypes;
     
-    // Get results
-    const Individual& getBestIndividual() const { return best_individual; }
-    double getBestFitness() const { return best_fitness; }
-    const std::vector<double>& getBestFitnessHistory() const { 
-        return best_fitness_history; 
-    }
-    const std::vector<double>& getAvgFitnessHistory() const { 
-        return avg_fitness_history; 
+    double* chromosomeAt(std::pmr::vector<double>& arena, int index) {
+        return arena.data() + static_cast<size_t>(index) * chromosome_length;
     }
     
-    // Print statistics
-    void printStatistics() const;
-    void printGenerationStats(int generation) const;
+    // GA operations (population-wide kernels over the arenas)
+    void initializePopulation(double min_val = -1.0, double max_val = 1.0);
+    void seedPopulation();
+    int tournamentSelection();
+    void selectParents();
+    void crossoverPopulation();
+    void blendPair(std::pmr::vector<double>& parents, std::pmr::vector<double>& children,
+                   const uint8_t* mask, int p1_idx, int p2_idx,
+                   int c1_idx, int c2_idx, bool has_c2);
+    void copyChromosome(std::pmr::vector<double>& src_arena, int src_idx,
+                        std::pmr::vector<double>& dst_arena, int dst_idx);
+    void copyPhenotype(std::pmr::vector<uint64_t>& src_arena, int src_idx,
+                       std::pmr::vector<uint64_t>& dst_arena, int dst_idx);
+    void addToGenotype(const double* chromosome);
+    void accumulateGenotype();
+    void mutatePopulation();
+    int eliteCount() const;
+    void replacePopulation();
+    void refineElites();
+    
+protected:
+    int maxGenerations() const override { return config.max_generations; }
+    void initializeState() override;
+    void processScores(const double* scores, const uint64_t* predictions) override;
+    GenotypeDiversity genotypeDiversity() const override;
+    double phenotypeDiversity() const override;
+    
+    // Keep the elites (at least the best), redraw the rest; the whole
+    // population is evaluated again as the next batch
+    void restartPopulation() override;
+    
+public:
+    // All population arenas are allocated from resource (e.g. a FoldArena)
+    GeneticAlgorithm(int chrom_length, const GAConfig& cfg = GAConfig(),
+                     std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    ~GeneticAlgorithm();
+    
+    // Ask/tell interface: the first batch is the initial population,
+    // every later batch is a full set of offspring
+    int batchSize() const override { return config.population_size; }
+    const double* ask() override;
+    double diversity() const override;
+    std::vector<std::vector<double>> getElites(int count) const override;
+    std::string name() const override { return "Genetic Algorithm"; }
 };
 
-// Helper function to create fitness function for MLP
-std::function<double(const std::vector<double>&)> createMLPFitnessFunction(
-    MLP& mlp,
-    const std::vector<std::vector<double>>& X_train,
-    const std::vector<int>& y_train
-);
-
-#endif // GA_H
\ No newline at end of file
+#endif // GA_H
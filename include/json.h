@@ -0,0 +1,62 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+// Minimal JSON reader for configuration files. Output files are written
+// by hand where they are produced; this only parses.
+class JsonValue {
+public:
+    enum class Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+
+private:
+    Type type;
+    bool bool_value;
+    double number_value;
+    std::string string_value;
+    std::vector<JsonValue> array_items;
+    std::vector<std::pair<std::string, JsonValue>> object_items;  // in file order
+
+    friend class JsonParser;
+
+public:
+    JsonValue() : type(Type::NUL), bool_value(false), number_value(0.0) {}
+
+    // Throws std::runtime_error with the line number on malformed input
+    static JsonValue parse(const std::string& text);
+    static JsonValue parseFile(const std::string& filename);
+
+    Type getType() const { return type; }
+    bool isNull() const { return type == Type::NUL; }
+    bool isNumber() const { return type == Type::NUMBER; }
+    bool isString() const { return type == Type::STRING; }
+    bool isArray() const { return type == Type::ARRAY; }
+    bool isObject() const { return type == Type::OBJECT; }
+
+    // Typed access; throws std::runtime_error on a type mismatch
+    bool asBool() const;
+    double asNumber() const;
+    int asInt() const;
+    long asLong() const;
+    const std::string& asString() const;
+    const std::vector<JsonValue>& asArray() const;
+    const std::vector<std::pair<std::string, JsonValue>>& asObject() const;
+
+    // Object members; operator[] throws if the key is missing
+    bool has(const std::string& key) const;
+    const JsonValue& operator[](const std::string& key) const;
+
+    // Object members with a fallback when the key is absent
+    double getNumber(const std::string& key, double fallback) const;
+    int getInt(const std::string& key, int fallback) const;
+    long getLong(const std::string& key, long fallback) const;
+    bool getBool(const std::string& key, bool fallback) const;
+    std::string getString(const std::string& key, const std::string& fallback) const;
+
+    // Throw if the object has a member not in allowed (catches typos)
+    void checkKeys(const std::vector<std::string>& allowed, const std::string& context) const;
+};
+
+#endif // JSON_H
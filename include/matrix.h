@@ -0,0 +1,61 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <vector>
+#include <memory_resource>
+#include <cstddef>
+
+// Dense row-major feature matrix; storage can come from an arena
+struct FeatureMatrix {
+    std::pmr::vector<double> values;
+    int rows;
+    int cols;
+    
+    explicit FeatureMatrix(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : values(resource), rows(0), cols(0) {}
+    FeatureMatrix(int r, int c,
+                  std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : values(static_cast<size_t>(r) * c, 0.0, resource), rows(r), cols(c) {}
+    
+    void resize(int r, int c) {
+        rows = r;
+        cols = c;
+        values.assign(static_cast<size_t>(r) * c, 0.0);
+    }
+    
+    double* row(int i) { return values.data() + static_cast<size_t>(i) * cols; }
+    const double* row(int i) const { return values.data() + static_cast<size_t>(i) * cols; }
+    
+    static FeatureMatrix fromRows(const std::vector<std::vector<double>>& data) {
+        FeatureMatrix m(static_cast<int>(data.size()), data.empty() ? 0 : static_cast<int>(data[0].size()));
+        for (int i = 0; i < m.rows; i++) {
+            for (int j = 0; j < m.cols; j++) {
+                m.row(i)[j] = data[i][j];
+            }
+        }
+        return m;
+    }
+};
+
+// Read-only view over labelled samples stored row-major. When rows is set,
+// sample i is source row rows[i] (for both features and labels), so folds
+// can be evaluated straight out of a shared matrix without copying.
+struct SampleView {
+    const double* data;    // source feature rows
+    int stride;            // doubles per source row
+    const int* labels;     // source labels (may be null)
+    const int* rows;       // optional source row indices
+    int count;             // number of samples in the view
+    
+    SampleView() : data(nullptr), stride(0), labels(nullptr), rows(nullptr), count(0) {}
+    SampleView(const FeatureMatrix& m, const int* y)
+        : data(m.values.data()), stride(m.cols), labels(y), rows(nullptr), count(m.rows) {}
+    SampleView(const FeatureMatrix& m, const std::vector<int>& y) : SampleView(m, y.data()) {}
+    SampleView(const FeatureMatrix& m, const std::pmr::vector<int>& y) : SampleView(m, y.data()) {}
+    
+    int sourceIndex(int i) const { return rows ? rows[i] : i; }
+    const double* row(int i) const { return data + static_cast<size_t>(sourceIndex(i)) * stride; }
+    int label(int i) const { return labels[sourceIndex(i)]; }
+};
+
+#endif // MATRIX_H
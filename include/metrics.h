@@ -0,0 +1,83 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+class ThreadPool;
+
+// Process-wide sweep progress, updated lock-free from the fold jobs
+struct SweepMetrics {
+    std::atomic<long> experiments_total;
+    std::atomic<long> experiments_completed;
+    std::atomic<long> folds_completed;
+    std::atomic<long> evaluations;
+    std::atomic<long> generations;
+    std::atomic<int64_t> last_progress_ns;  // steady clock of the last batch
+
+    SweepMetrics();
+
+    // Called once per evaluated optimizer batch
+    void recordProgress(long evaluation_count, long generation_count);
+
+    static SweepMetrics& global();
+};
+
+// Serves the sweep metrics while it runs: Prometheus text format on
+// http://127.0.0.1:<port>/metrics (JSON on /metrics.json) and, optionally,
+// a JSON snapshot rewritten every interval. Rates are computed over the
+// last sampling interval.
+class MetricsExporter {
+private:
+    struct Snapshot {
+        int64_t time_ns;
+        long evaluations;
+        long generations;
+        std::vector<int64_t> busy_ns;
+    };
+
+    const ThreadPool& pool;
+    int port;
+    std::string json_path;
+    double interval_seconds;
+    int listen_fd;
+    std::thread thread;
+    std::atomic<bool> stopping;
+    int64_t start_ns;
+
+    // Latest rates, guarded by mutex
+    std::mutex mutex;
+    Snapshot previous;
+    double evaluations_per_second;
+    double generations_per_second;
+    std::vector<double> utilization;
+
+    void run();
+    void sample();
+    void serveClient(int client_fd);
+    bool openSocket();
+
+public:
+    explicit MetricsExporter(const ThreadPool& thread_pool);
+    ~MetricsExporter();
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Start the background thread. port <= 0 disables HTTP, an empty
+    // json_file disables the snapshot file. Returns false if the socket
+    // could not be bound.
+    bool start(int http_port, const std::string& json_file, double interval = 5.0);
+    void stop();
+
+    std::string prometheusText();
+    std::string jsonText();
+
+    // Resident set size of this process in bytes (0 if unknown)
+    static long residentBytes();
+};
+
+#endif // METRICS_H
@@ -2,9 +2,11 @@
 #define MLP_H
 
 #include "utils.h"
+#include "matrix.h"
 
 #include <iostream>
 #include <cmath>
+#include <cstdint>
 #include <random>
 #include <stdexcept>
 #include <vector>
@@ -16,54 +18,200 @@ enum class ActivationType {
     RELU
 };
 
+ActivationType parseActivationType(const std::string& name);
+std::string activationTypeName(ActivationType type);
+
+// Fitness kernels, all computed from one batched pass over the outputs.
+// Each maps to (0, 1] (ACCURACY_MARGIN: [0, 1 + 0.5/n)) with higher = better.
+enum class FitnessType {
+    ACCURACY,         // fraction correct (step function)
+    LOG_LOSS,         // exp(-mean binary cross-entropy)
+    HINGE_MARGIN,     // 1 / (1 + mean hinge loss on the output logit)
+    ACCURACY_MARGIN   // accuracy, ties broken by mean tanh(margin) below 1/n
+};
+
+FitnessType parseFitnessType(const std::string& name);
+std::string fitnessTypeName(FitnessType type);
+
+// Everything one batched pass over a labelled sample set produces:
+// the binary confusion matrix (class 1 = positive) plus the loss sums
+// needed by the fitness kernels
+struct EvaluationStats {
+    int count;
+    int correct;
+    int true_positive;
+    int true_negative;
+    int false_positive;
+    int false_negative;
+    double log_loss_sum;
+    double hinge_sum;
+    double margin_sum;
+    
+    EvaluationStats()
+        : count(0), correct(0), true_positive(0), true_negative(0),
+          false_positive(0), false_negative(0),
+          log_loss_sum(0.0), hinge_sum(0.0), margin_sum(0.0) {}
+    
+    double accuracy() const { return count > 0 ? static_cast<double>(correct) / count : 0.0; }
+    double fitness(FitnessType type) const;
+    Utils::ClassificationMetrics metrics() const;
+};
+
+// Predictions can be recorded as a bitset per network, bit r of word
+// r / 64 set when sample r is predicted positive
+inline int predictionWords(int samples) { return (samples + 63) / 64; }
+
+class MLP;
+struct InputNormalization;
+
+// Per-thread inference scratch. All activation, delta and logit buffers
+// for one network shape live in a single arena, so a context can be kept
+// per worker and reused across evaluations without reallocating.
+class MLPContext {
+private:
+    friend class MLP;
+    friend class PackedMLPEvaluator;
+    
+    static const int block_size = 64;
+    
+    std::vector<double> arena;
+    std::vector<double*> activations;  // [layer] block_size x layer_sizes[layer]
+    std::vector<double*> deltas;       // [layer] block_size x layer_sizes[layer]
+    double* logits;                    // block_size x output pre-activations
+    std::vector<int> shape;            // layer sizes the arena is laid out for
+    std::vector<double> folded;        // parameters with the input normalization folded in
+    
+public:
+    MLPContext() : logits(nullptr) {}
+    explicit MLPContext(const MLP& mlp);
+    
+    // Lay the arena out for mlp's shape (no-op if already shaped for it)
+    void reserve(const MLP& mlp);
+};
+
+// Network structure and parameters. Every evaluation method is const and
+// takes its scratch from an MLPContext, so one MLP can be shared by many
+// threads, each evaluating the stored weights or any chromosome passed in.
 class MLP {
 private:
     std::vector<int> layer_sizes;  // [input, hidden1, hidden2, ..., output]
     ActivationType activation_type;
     int total_params;  // Total number of weights and biases
     
-    // Network parameters (weights and biases for each layer)
-    std::vector<std::vector<std::vector<double>>> weights;  // [layer][from][to]
-    std::vector<std::vector<double>> biases;  // [layer][neuron]
+    // Network parameters in chromosome order: for each layer the weights
+    // [from][to] row-major, followed by the biases [to]
+    std::pmr::vector<double> params;
+    std::vector<int> weight_offsets;  // [layer] start of weights in params
+    std::vector<int> bias_offsets;    // [layer] start of biases in params
     
-    // For forward pass
-    std::vector<std::vector<double>> layer_outputs;  // Store outputs of each layer
+    // Per-fold input z-scoring (not owned; null = inputs used as given)
+    const InputNormalization* input_normalization;
     
     // Activation functions
     double sigmoid(double x) const;
     double tanh_activation(double x) const;
     double relu(double x) const;
     double activate(double x) const;
+    double activateDerivative(double activated) const;
     
     // Helper for chromosome conversion
     void decodeChromosome(const std::vector<double>& chromosome);
     
+    // Forward count (<= block size) samples starting at begin through the
+    // network; the output layer lands in ctx.activations.back(). With
+    // first_layer > 0, ctx.activations[first_layer] must already be filled.
+    void forwardBlock(const double* p, const SampleView& samples, int begin, int count,
+                      MLPContext& ctx, int first_layer = 0) const;
+    
+    // Add a forwarded block's outputs to stats (and their predictions to
+    // the bitset, if given)
+    void accumulateBlock(const SampleView& samples, int begin, int count,
+                         FitnessType type, const MLPContext& ctx, EvaluationStats& stats,
+                         uint64_t* predictions) const;
+    
 public:
-    MLP(const std::vector<int>& layers, ActivationType act_type = ActivationType::SIGMOID);
+    MLP(const std::vector<int>& layers, ActivationType act_type = ActivationType::SIGMOID,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     ~MLP();
     
     // Get chromosome length (number of parameters)
     int getChromosomeLength() const { return total_params; }
     
+    // Flops of one sample's forward pass (multiply-add = 2, bias = 1)
+    long long forwardFlops() const;
+    
     // Convert weights/biases to chromosome (flat vector)
     std::vector<double> encodeChromosome() const;
     
     // Set weights/biases from chromosome
     void setWeights(const std::vector<double>& chromosome);
+    const std::pmr::vector<double>& getParameters() const { return params; }
+    
+    // Treat inputs as z-scored with norm's statistics without touching the
+    // samples: chromosomes stay in normalized-input space and every pass
+    // folds W/s and b - W m/s into the first layer. norm must outlive the
+    // MLP's use; null or empty turns it off.
+    void setInputNormalization(const InputNormalization* norm);
+    
+    // p for raw inputs: p itself without a normalization, else a copy
+    // with the first layer folded, written to folded
+    const double* foldInputs(const double* p, std::vector<double>& folded) const;
     
     // Forward pass - returns output layer activations
-    std::vector<double> forward(const std::vector<double>& input);
+    std::vector<double> forward(const std::vector<double>& input, MLPContext& ctx) const;
+    std::vector<double> forward(const std::vector<double>& input) const;
     
     // Predict class (0 or 1)
-    int predict(const std::vector<double>& input);
+    int predict(const std::vector<double>& input, MLPContext& ctx) const;
+    int predict(const std::vector<double>& input) const;
     
     // Evaluate accuracy on dataset
     double evaluateAccuracy(const std::vector<std::vector<double>>& X,
-                           const std::vector<int>& y);
+                           const std::vector<int>& y) const;
+    
+    // Batched accuracy of the current weights over a sample view
+    double evaluateAccuracy(const SampleView& samples) const;
+    
+    // One fused pass over samples with parameters p (chromosome layout),
+    // producing accuracy, confusion matrix and the loss term for the given
+    // fitness type. Reentrant: all scratch comes from ctx. predictions,
+    // if given, receives the predictionWords(samples.count) bitset.
+    EvaluationStats evaluate(const double* p, const SampleView& samples,
+                             FitnessType type, MLPContext& ctx,
+                             uint64_t* predictions = nullptr) const;
+    
+    // Same with the stored weights and a temporary context
+    EvaluationStats evaluate(const SampleView& samples,
+                             FitnessType type = FitnessType::ACCURACY) const;
+    
+    // Packed multi-network path (PackedMLPEvaluator): ctx.activations[1]
+    // holds a block's first-layer pre-activations; activate them, run the
+    // remaining layers and add the block to stats. Needs a hidden layer.
+    void finishBlock(const double* p, const SampleView& samples, int begin, int count,
+                     FitnessType type, MLPContext& ctx, EvaluationStats& stats,
+                     uint64_t* predictions = nullptr) const;
+    
+    // Fused batched fitness of parameters p over a sample view
+    double evaluateFitness(const double* p, const SampleView& samples,
+                           FitnessType type, MLPContext& ctx) const;
+    
+    // Accuracy, TP/TN/FP/FN and derived metrics from a single pass
+    Utils::ClassificationMetrics evaluateMetrics(const SampleView& samples) const;
+    
+    // Batched backpropagation on the flat parameter layout: writes the
+    // gradient of the mean binary cross-entropy w.r.t. p into grad (same
+    // layout as the chromosome) and returns the loss
+    double computeGradient(const double* p, const SampleView& samples, double* grad,
+                           MLPContext& ctx) const;
+    
+    // Full-batch gradient descent on a chromosome in place
+    void gradientDescent(std::vector<double>& chromosome, const SampleView& samples,
+                         int steps, double learning_rate, MLPContext& ctx) const;
     
     // Get network structure info
     const std::vector<int>& getLayerSizes() const { return layer_sizes; }
     int getNumLayers() const { return layer_sizes.size(); }
+    ActivationType getActivationType() const { return activation_type; }
     
     // Random initialization
     void randomInitialize(double min_val = -1.0, double max_val = 1.0);
@@ -72,4 +220,4 @@ public:
     void printStructure() const;
 };
 
-#endif // MLP_H
\ No newline at end of file
+#endif // MLP_H
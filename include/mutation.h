@@ -0,0 +1,61 @@
+#ifndef MUTATION_H
+#define MUTATION_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include "utils.h"
+
+enum class MutationType {
+    UNIFORM,        // uniform noise in [-strength, strength]
+    GAUSSIAN,       // N(0, strength^2) noise
+    CAUCHY,         // Cauchy(0, strength) noise, heavier tails
+    SELF_ADAPTIVE   // per-gene step sizes evolved with the genes (ES-style)
+};
+
+struct MutationParams {
+    MutationType type;
+    double rate;        // per-gene mutation probability
+    double strength;    // noise scale / initial step size
+    double min_step;    // lower bound on self-adaptive step sizes
+    double gene_limit;  // genes are clamped to [-gene_limit, gene_limit]
+    
+    MutationParams()
+        : type(MutationType::GAUSSIAN),
+          rate(0.1),
+          strength(0.3),
+          min_step(1e-4),
+          gene_limit(5.0) {}
+};
+
+class MutationOperator {
+protected:
+    MutationParams params;
+    
+    // Bulk random buffers, grown on demand
+    std::vector<double> draws;
+    std::vector<double> noise;
+    
+public:
+    explicit MutationOperator(const MutationParams& p) : params(p) {}
+    virtual ~MutationOperator() {}
+    
+    // True if the operator needs a step-size arena alongside the genes
+    virtual bool usesStepSizes() const { return false; }
+    
+    // Mutate num_individuals contiguous chromosomes of the given length in place.
+    // step_sizes has the same layout as genes, or is null if !usesStepSizes().
+    virtual void apply(double* genes, double* step_sizes, int num_individuals,
+                       int length, Utils::FastRandom& rng) = 0;
+    
+    const MutationParams& getParams() const { return params; }
+};
+
+// Create the operator selected by params.type
+std::unique_ptr<MutationOperator> createMutationOperator(const MutationParams& params);
+
+// Parse / print mutation type names ("uniform", "gaussian", ...)
+MutationType parseMutationType(const std::string& name);
+std::string mutationTypeName(MutationType type);
+
+#endif // MUTATION_H
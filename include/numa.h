@@ -0,0 +1,32 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <vector>
+#include <string>
+
+// NUMA nodes and their CPUs, read from /sys/devices/system/node on Linux
+// (the online nodes, renumbered densely from 0). Anywhere the topology is
+// unavailable it is a single node holding every hardware thread, so
+// callers need no special case.
+struct NumaTopology {
+    std::vector<std::vector<int>> node_cpus;  // [node] CPU ids
+
+    static NumaTopology detect();
+
+    int numNodes() const { return static_cast<int>(node_cpus.size()); }
+
+    // CPU and node for worker i of a pool: workers are dealt round-robin
+    // over the nodes (i % nodes), then take the next CPU of their node, so
+    // a pool smaller than the machine still spreads over every socket
+    int cpuForWorker(int worker) const;
+    int nodeForWorker(int worker) const;
+
+    std::string describe() const;
+};
+
+// Restrict the calling thread to one CPU (or every CPU of a node); false
+// when affinity is not supported or the call fails
+bool pinCurrentThread(int cpu);
+bool pinCurrentThreadToNode(const NumaTopology& topology, int node);
+
+#endif // NUMA_H
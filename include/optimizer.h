@@ -0,0 +1,344 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <memory_resource>
+#include "mlp.h"
+
+struct Individual {
+    std::vector<double> chromosome;
+    double fitness;
+    
+    Individual() : fitness(0.0) {}
+    Individual(int size) : chromosome(size), fitness(0.0) {}
+};
+
+enum class OptimizerType {
+    GA,         // tournament genetic algorithm (ga.h)
+    SEP_CMAES   // separable CMA-ES (cmaes.h)
+};
+
+typedef std::function<double(const std::vector<double>&)> FitnessFunction;
+
+// Scores count contiguous chromosomes at once into scores[0..count).
+// predictions, when not null, receives each chromosome's training-set
+// prediction bitset (Optimizer::predictionWords() words apiece).
+typedef std::function<void(const double* genes, int count, double* scores,
+                           uint64_t* predictions)> BatchFitnessFunction;
+
+// Refines a chromosome in place (e.g. a few gradient steps)
+typedef std::function<void(std::vector<double>&)> LocalSearchFunction;
+
+// Early stopping; a zero value disables the corresponding criterion
+struct StoppingCriteria {
+    int stagnation_generations;   // no best-fitness gain for this many generations
+    double stagnation_tolerance;  // gain at or below this counts as no gain
+    double min_diversity;         // population diversity collapse threshold
+    double target_fitness;        // stop once best fitness reaches this
+    long max_evaluations;         // fitness evaluation budget
+    double max_seconds;           // wall-clock budget
+    
+    StoppingCriteria()
+        : stagnation_generations(0),
+          stagnation_tolerance(1e-9),
+          min_diversity(0.0),
+          target_fitness(0.0),
+          max_evaluations(0),
+          max_seconds(0.0) {}
+};
+
+// Re-seed a converged population instead of letting it idle until the
+// stagnation stop; a zero threshold disables the corresponding trigger
+struct RestartCriteria {
+    double min_gene_variance;     // mean per-gene variance below this
+    double min_disagreement;      // prediction disagreement below this (needs phenotypes)
+    int max_restarts;             // per optimization
+    
+    RestartCriteria()
+        : min_gene_variance(0.0),
+          min_disagreement(0.0),
+          max_restarts(3) {}
+};
+
+// Genotypic spread of a population or search distribution
+struct GenotypeDiversity {
+    double gene_variance;         // mean per-gene variance
+    double pairwise_distance;     // RMS distance between two individuals,
+                                  // from the variances around the centroid
+    
+    GenotypeDiversity() : gene_variance(0.0), pairwise_distance(0.0) {}
+};
+
+enum class StopReason {
+    NONE,
+    MAX_GENERATIONS,
+    STAGNATION,
+    DIVERSITY_COLLAPSE,
+    TARGET_REACHED,
+    EVALUATION_BUDGET,
+    TIME_BUDGET
+};
+
+std::string stopReasonName(StopReason reason);
+
+// Sum and best of a scored batch, reduced while the batch is evaluated so
+// the engines need no second pass over the scores. Ties go to the lowest
+// index, like std::max_element.
+struct BatchStats {
+    double sum;
+    double best;
+    int best_index;              // -1 = empty
+    int count;
+
+    BatchStats() : sum(0.0), best(0.0), best_index(-1), count(0) {}
+
+    void add(int index, double score) {
+        sum += score;
+        count++;
+        if (best_index < 0 || score > best) {
+            best = score;
+            best_index = index;
+        }
+    }
+};
+
+// Common ask/tell interface shared by all optimization engines.
+// Each generation the engine exposes batchSize() contiguous chromosomes
+// through ask(), the caller scores them, and tell() consumes the scores.
+// evolve() runs that loop with the configured fitness function.
+class Optimizer {
+protected:
+    int chromosome_length;
+    bool verbose;
+    int generation;
+    long evaluations;
+    StopReason stop_reason;
+    StoppingCriteria stopping;
+    std::chrono::steady_clock::time_point start_time;
+    double best_fitness;
+    Individual best_individual;
+    
+    // Fitness function (external); the batch form is preferred when set
+    FitnessFunction fitness_function;
+    BatchFitnessFunction batch_fitness_function;
+    
+    // Optional local search used by memetic engines
+    LocalSearchFunction local_search;
+    
+    // Statistics
+    std::vector<double> best_fitness_history;
+    std::vector<double> avg_fitness_history;
+    std::vector<double> gene_variance_history;
+    std::vector<double> pairwise_distance_history;
+    std::vector<double> disagreement_history;     // empty unless phenotypes are tracked
+    
+    // Phenotypes: predictionWords() words of training-set predictions per
+    // individual (0 = not tracked)
+    int phenotype_samples;
+    int phenotype_words;
+    std::pmr::vector<uint64_t> batch_predictions;
+    mutable std::pmr::vector<int> sample_positives;    // predictionDisagreement scratch
+    
+    RestartCriteria restart;
+    int restarts;
+    int restart_generation;      // generation of the last restart (0 = none yet)
+    
+    // Warm start for the next initialize(); empty = random initialization
+    std::vector<std::vector<double>> seed_chromosomes;
+    double seed_random_fraction;
+    double seed_perturbation;
+    
+    // Evaluation scratch
+    std::vector<double> eval_buffer;
+    std::pmr::vector<double> batch_scores;
+    
+    // Statistics of the last evaluateBatch; stats_scores is the score
+    // array batch_stats describes (null once consumed by scoreStats)
+    BatchStats batch_stats;
+    const double* stats_scores;
+    
+    // Score count contiguous chromosomes with the fitness function,
+    // reducing them as they come in (see scoreStats()). predictions
+    // (batch fitness function only) receives the prediction bitsets.
+    void evaluateBatch(const double* genes, int count, double* scores,
+                       uint64_t* predictions = nullptr);
+    
+    // Statistics of scores[0..count): the reduction evaluateBatch made of
+    // them if it produced them, a serial pass otherwise (scores told by an
+    // external evaluator)
+    const BatchStats& scoreStats(const double* scores, int count);
+    
+    // Copy the batch's best chromosome, found by index in stats, if it
+    // beats best_fitness (at most one copy per batch)
+    void updateBest(const double* genes, const BatchStats& stats);
+    
+    // Share of (individual pair, sample) predictions that differ across
+    // count prediction bitsets
+    double predictionDisagreement(const uint64_t* predictions, int count) const;
+    
+    // Append history for a finished generation, print progress and check
+    // the stopping criteria. The restart triggers are evaluated before
+    // the stagnation and diversity-collapse stops, and stagnation is
+    // measured from the last restart.
+    void recordGeneration(double avg_fitness);
+    void checkStopping();
+    
+    // Re-seed the population if a restart trigger fired since the last
+    // restart; true if it did
+    bool checkRestart();
+    
+    // Engine-specific hooks. predictions is null unless phenotypes are
+    // tracked. phenotypeDiversity() is only called when they are.
+    virtual int maxGenerations() const = 0;
+    virtual void initializeState() = 0;
+    virtual void processScores(const double* scores, const uint64_t* predictions) = 0;
+    virtual GenotypeDiversity genotypeDiversity() const = 0;
+    virtual double phenotypeDiversity() const = 0;
+    virtual void restartPopulation() = 0;
+    
+public:
+    Optimizer(int chrom_length, bool verbose_output,
+              std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    virtual ~Optimizer() {}
+    
+    // Set fitness function
+    void setFitnessFunction(FitnessFunction func);
+    
+    // Score whole batches with one call (e.g. a population-batched
+    // forward pass)
+    void setBatchFitnessFunction(BatchFitnessFunction func) { batch_fitness_function = func; }
+    
+    // Set a local search for engines that refine individuals in place
+    // (the GA applies it to its best local_search_elites each generation)
+    void setLocalSearch(LocalSearchFunction func) { local_search = func; }
+    
+    // Set early stopping criteria (default: run all generations)
+    void setStoppingCriteria(const StoppingCriteria& criteria) { stopping = criteria; }
+    
+    // Set restart triggers (default: never restart)
+    void setRestartCriteria(const RestartCriteria& criteria) { restart = criteria; }
+    
+    // Track each individual's predictions on the samples training
+    // samples, for the phenotypic diversity; evaluation must then go
+    // through the batch fitness function, or tell() get the bitsets
+    void setPhenotypeSamples(int samples);
+    int predictionWords() const { return phenotype_words; }
+    
+    // Warm start from known-good chromosomes (of this chromosome length).
+    // random_fraction of the population stays random for diversity; copies
+    // beyond the first of each seed get N(0, perturbation^2) gene noise.
+    void setSeedChromosomes(const std::vector<std::vector<double>>& seeds,
+                            double random_fraction, double perturbation);
+    
+    // Up to count best chromosomes of the final state, best first
+    virtual std::vector<std::vector<double>> getElites(int count) const;
+    
+    // Ask/tell interface; tell() consumes scores for the last ask() batch
+    // (and, with phenotypes tracked, batchSize() prediction bitsets)
+    void initialize();
+    virtual int batchSize() const = 0;
+    virtual const double* ask() = 0;
+    void tell(const double* scores, const uint64_t* predictions = nullptr);
+    bool isFinished() const { return stop_reason != StopReason::NONE; }
+    virtual std::string name() const = 0;
+    
+    // Spread of the current population / search distribution
+    virtual double diversity() const = 0;
+    
+    // Run the full optimization with the fitness function
+    void evolve();
+    
+    // Get results
+    int getChromosomeLength() const { return chromosome_length; }
+    const Individual& getBestIndividual() const { return best_individual; }
+    double getBestFitness() const { return best_fitness; }
+    int getGeneration() const { return generation; }
+    long getEvaluations() const { return evaluations; }
+    StopReason getStopReason() const { return stop_reason; }
+    const std::vector<double>& getBestFitnessHistory() const { 
+        return best_fitness_history; 
+    }
+    const std::vector<double>& getAvgFitnessHistory() const { 
+        return avg_fitness_history; 
+    }
+    const std::vector<double>& getGeneVarianceHistory() const {
+        return gene_variance_history;
+    }
+    const std::vector<double>& getPairwiseDistanceHistory() const {
+        return pairwise_distance_history;
+    }
+    const std::vector<double>& getDisagreementHistory() const {
+        return disagreement_history;
+    }
+    int getRestarts() const { return restarts; }
+    
+    // Print statistics
+    virtual void printStatistics() const;
+    void printGenerationStats(int generation) const;
+};
+
+struct GAConfig;
+struct CMAESConfig;
+
+// Create the engine selected by type; each engine reads its own config and
+// allocates its population buffers from resource
+std::unique_ptr<Optimizer> createOptimizer(
+    OptimizerType type,
+    int chromosome_length,
+    const GAConfig& ga_config,
+    const CMAESConfig& cmaes_config,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+// Parse / print optimizer names ("ga", "sep_cmaes")
+OptimizerType parseOptimizerType(const std::string& name);
+std::string optimizerTypeName(OptimizerType type);
+
+// Helper function to create fitness function for MLP. The returned
+// functions never modify mlp and keep a per-thread MLPContext, so they
+// may be called concurrently.
+FitnessFunction createMLPFitnessFunction(
+    const MLP& mlp,
+    const std::vector<std::vector<double>>& X_train,
+    const std::vector<int>& y_train,
+    FitnessType fitness_type = FitnessType::ACCURACY
+);
+
+// Same over a sample view; the view's storage must outlive the function
+FitnessFunction createMLPFitnessFunction(
+    const MLP& mlp,
+    const SampleView& train,
+    FitnessType fitness_type = FitnessType::ACCURACY
+);
+
+// Population-batched fitness: a batch's first-layer weights are stacked
+// into one matrix (PackedMLPEvaluator), so each training row is read once
+// per tile of individuals instead of once per individual. Scores equal
+// the per-chromosome function's; thread-safe like it.
+BatchFitnessFunction createMLPBatchFitnessFunction(
+    const MLP& mlp,
+    const SampleView& train,
+    FitnessType fitness_type = FitnessType::ACCURACY
+);
+
+// Helper to create a Lamarckian local search that runs a few full-batch
+// backpropagation steps on the training fold
+LocalSearchFunction createMLPLocalSearch(
+    const MLP& mlp,
+    const std::vector<std::vector<double>>& X_train,
+    const std::vector<int>& y_train,
+    int steps,
+    double learning_rate
+);
+
+LocalSearchFunction createMLPLocalSearch(
+    const MLP& mlp,
+    const SampleView& train,
+    int steps,
+    double learning_rate
+);
+
+#endif // OPTIMIZER_H
@@ -0,0 +1,46 @@
+#ifndef PACKED_MLP_H
+#define PACKED_MLP_H
+
+#include <vector>
+#include <map>
+#include "mlp.h"
+
+// Evaluates many networks of different architectures over the same
+// samples. Their first layers (the bulk of the work for 30-input nets)
+// are packed side by side into one wide weight matrix, so a 30-5-1 net
+// shares the vectorized input kernel with everything else in its tile
+// instead of running a 5-wide inner loop on its own. The remaining
+// layers run per network. Per-output summation order matches
+// MLP::evaluate, so the stats are identical to evaluating each lane alone.
+class PackedMLPEvaluator {
+public:
+    struct Lane {
+        const MLP* mlp;
+        const double* params;   // chromosome layout
+        uint64_t* predictions;  // optional prediction bitset (see predictionWords)
+    };
+
+private:
+    static const int max_tile_width = 256;  // packed first-layer columns per tile
+
+    std::vector<double> weights;   // input_width x tile width, row-major
+    std::vector<double> biases;    // tile width
+    std::vector<double> block;     // block_size x tile width pre-activations
+    std::vector<int> offsets;      // [lane in tile] first packed column
+    std::vector<double> folded;    // a lane's parameters with its input normalization
+    // Block scratch is only live while one lane finishes a block, so lanes
+    // of the same shape share a context
+    std::map<std::vector<int>, MLPContext> contexts;
+    std::vector<MLPContext*> lane_contexts;  // [lane]
+
+    void evaluateTile(const std::vector<Lane>& lanes, int first, int last,
+                      const SampleView& samples, FitnessType type, EvaluationStats* stats);
+
+public:
+    // stats[i] for lanes[i]; lanes must share the input width.
+    // Lanes without a hidden layer fall back to MLP::evaluate.
+    void evaluate(const std::vector<Lane>& lanes, const SampleView& samples,
+                  FitnessType type, EvaluationStats* stats);
+};
+
+#endif // PACKED_MLP_H
@@ -0,0 +1,55 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+
+// One reading of the hardware counters (values since the group was opened)
+struct PerfSample {
+    int64_t cycles;
+    int64_t instructions;
+    int64_t cache_references;
+    int64_t cache_misses;
+    int64_t branch_misses;
+
+    PerfSample()
+        : cycles(0), instructions(0), cache_references(0),
+          cache_misses(0), branch_misses(0) {}
+
+    PerfSample operator-(const PerfSample& other) const;
+    PerfSample& operator+=(const PerfSample& other);
+};
+
+// Hardware counters for the calling thread, opened as one perf_event_open
+// group (user space only) so all values cover the same interval. Falls
+// back to all-zero readings when perf events are unavailable (non-Linux,
+// containers, perf_event_paranoid too strict).
+class PerfCounters {
+private:
+    static const int num_events = 5;
+
+    int fds[num_events];
+    bool available;
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool isAvailable() const { return available; }
+
+    // Current totals, scaled up if the kernel multiplexed the group
+    PerfSample read() const;
+
+    // Counters of the calling thread, opened on first use
+    static PerfCounters& forThread();
+
+    // Whether this process can open perf events at all
+    static bool supported();
+
+    // Double-precision flops per cycle per core for the SIMD level this
+    // binary was compiled for (FMA counted as two)
+    static int peakFlopsPerCycle();
+};
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,135 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include "perf_counters.h"
+
+// Scoped timers and counters for the hot paths. Build with -DMLP_GA_PROFILE
+// (cmake -DENABLE_PROFILING=ON) to turn them on; otherwise every macro
+// expands to nothing and the report functions write empty reports.
+//
+// Each thread records into its own buffers, keyed by scope name and the
+// current tag (the architecture being trained), so recording takes no locks.
+// Reports must be written while the workers are idle.
+namespace Profiler {
+#ifdef MLP_GA_PROFILE
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+    // Nanoseconds since the profiler epoch (process start)
+    int64_t now();
+
+    // Add one timed call of name to the calling thread's totals; with
+    // trace set, also keep it as a trace event (up to the trace limit)
+    void recordScope(const char* name, int64_t start_ns, int64_t end_ns, bool trace);
+
+    // Add value to the calling thread's counter name
+    void recordCount(const char* name, int64_t value);
+
+    // Tag attached to everything the calling thread records from now on
+    void setTag(const std::string& tag);
+    std::string currentTag();
+
+    // Hardware counters (perf_event_open) around PROFILE_PERF scopes. Off
+    // by default: each reading is a syscall, which would skew the timers.
+    void enableHardwareCounters(bool enable);
+    bool hardwareCountersEnabled();
+
+    // Add one counted call of name to the calling thread's hardware totals
+    void recordHardware(const char* name, const PerfSample& delta, int64_t duration_ns);
+
+    // Maximum trace events kept per thread (aggregates are never dropped)
+    void setTraceLimit(int64_t events_per_thread);
+
+    // Totals per thread and per tag, merged by name across threads
+    bool writeJSON(const std::string& filename);
+
+    // Trace events in Chrome trace-event format (chrome://tracing, Perfetto)
+    bool writeChromeTrace(const std::string& filename);
+
+    // Drop everything recorded so far
+    void clear();
+
+    class ScopedTimer {
+    private:
+        const char* name;
+        bool trace;
+        int64_t start;
+
+    public:
+        ScopedTimer(const char* scope_name, bool keep_trace)
+            : name(scope_name), trace(keep_trace), start(now()) {}
+        ~ScopedTimer() { recordScope(name, start, now(), trace); }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    };
+
+    // Reads the thread's hardware counters on entry and exit
+    class ScopedPerf {
+    private:
+        const char* name;
+        bool active;
+        PerfSample start;
+        int64_t start_ns;
+
+    public:
+        explicit ScopedPerf(const char* scope_name)
+            : name(scope_name), active(hardwareCountersEnabled()), start_ns(0) {
+            if (active) {
+                start = PerfCounters::forThread().read();
+                start_ns = now();
+            }
+        }
+        ~ScopedPerf() {
+            if (active) {
+                int64_t end_ns = now();
+                recordHardware(name, PerfCounters::forThread().read() - start, end_ns - start_ns);
+            }
+        }
+        ScopedPerf(const ScopedPerf&) = delete;
+        ScopedPerf& operator=(const ScopedPerf&) = delete;
+    };
+
+    // Sets the tag for the lifetime of the scope, then restores the old one
+    class ScopedTag {
+    private:
+        std::string previous;
+
+    public:
+        explicit ScopedTag(const std::string& tag) : previous(currentTag()) { setTag(tag); }
+        ~ScopedTag() { setTag(previous); }
+        ScopedTag(const ScopedTag&) = delete;
+        ScopedTag& operator=(const ScopedTag&) = delete;
+    };
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef MLP_GA_PROFILE
+// Aggregate-only timer, for scopes entered millions of times
+#define PROFILE_SCOPE(name) \
+    Profiler::ScopedTimer PROFILE_CONCAT(profile_scope_, __LINE__)(name, false)
+// Timer that also emits a trace event, for coarse phases
+#define PROFILE_TRACE(name) \
+    Profiler::ScopedTimer PROFILE_CONCAT(profile_scope_, __LINE__)(name, true)
+#define PROFILE_COUNT(name, value) Profiler::recordCount(name, value)
+// Hardware counters over the scope; a "<name>.flops" counter recorded
+// under the same tag turns the report into achieved GFLOP/s
+#define PROFILE_PERF(name) \
+    Profiler::ScopedPerf PROFILE_CONCAT(profile_perf_, __LINE__)(name)
+#define PROFILE_TAG(tag) \
+    Profiler::ScopedTag PROFILE_CONCAT(profile_tag_, __LINE__)(tag)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_TRACE(name) ((void)0)
+#define PROFILE_COUNT(name, value) ((void)0)
+#define PROFILE_PERF(name) ((void)0)
+#define PROFILE_TAG(tag) ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -12,11 +12,18 @@ struct FoldResult {
     Utils::ClassificationMetrics train_metrics;
     Utils::ClassificationMetrics test_metrics;
     int generations_used;
+    long evaluations_used;
+    std::string stop_reason;
     double best_fitness;
+    std::string initialization;  // "random", "previous_fold" or "elite_bank"
+    int generations_to_reference;  // first generation reaching the experiment's
+                                   // first-fold best fitness (warm start only)
+    std::string inputs;          // "all", "pcaK" or the fold's selected input columns
 };
 
 struct ExperimentResult {
     std::vector<int> network_structure;
+    std::string activation;
     int run_id;
     unsigned int seed;
     std::vector<FoldResult> fold_results;
@@ -24,10 +31,12 @@ struct ExperimentResult {
     double std_test_accuracy;
     double mean_train_accuracy;
     double std_train_accuracy;
+    bool warm_start;             // folds seeded from each other: not independent
+    int plan_index;              // position in the sweep plan (shard files)
     
-    ExperimentResult() : run_id(0), seed(0), mean_test_accuracy(0.0), 
+    ExperimentResult() : activation("sigmoid"), run_id(0), seed(0), mean_test_accuracy(0.0), 
                         std_test_accuracy(0.0), mean_train_accuracy(0.0), 
-                        std_train_accuracy(0.0) {}
+                        std_train_accuracy(0.0), warm_start(false), plan_index(0) {}
     
     void calculate();
     void print() const;
@@ -46,8 +55,15 @@ public:
     void printSummary() const;
     void printComparison() const;
     
-    void saveAllResults(const std::string& filename) const;
-    void saveSummaryResults(const std::string& filename) const;
+    // Mean generations of randomly initialized vs warm-started folds
+    void printWarmStartSavings() const;
+    
+    // A positive plan_experiments writes a shard file: a leading
+    // "#Plan_Experiments,M" line (the full plan's size) and an Experiment
+    // column (the plan position) so merge_shards can restore plan order
+    // and check that every experiment is there
+    void saveAllResults(const std::string& filename, int plan_experiments = 0) const;
+    void saveSummaryResults(const std::string& filename, int plan_experiments = 0) const;
     
     const std::vector<ExperimentResult>& getExperiments() const { 
         return experiments; 
@@ -0,0 +1,68 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <set>
+#include "sweep.h"
+
+// Multi-fidelity architecture search (successive halving / Hyperband)
+// driven through the sweep runner. Every rung reuses runs first_run ..
+// of the spec with the same seeds, so a survivor's final rung is exactly
+// the experiment the full grid would have produced for it.
+class ArchitectureSearch {
+private:
+    struct RungRecord {
+        int bracket;
+        int rung;
+        Candidate candidate;
+        int runs;
+        int generations;
+        double mean_test_accuracy;
+        bool promoted;
+    };
+
+    const SweepSpec& spec;
+    const Dataset& dataset;
+    SweepRunner& runner;
+
+    std::vector<Candidate> candidates;
+    std::vector<RungRecord> records;
+    std::map<std::string, double> rung_cache;  // candidate@budget -> mean test accuracy
+    std::map<std::string, std::vector<ExperimentResult>> full_results;
+    std::set<std::string> finalists;           // already in the final results
+    long long generations_spent;
+    int num_rungs;                             // K + 1
+
+    int maxGenerations() const;
+    int rungGenerations(int rung) const;
+    int rungRuns(int rung) const;
+
+    static std::string candidateName(const Candidate& candidate);
+
+    // Score candidates at one rung's budget; the final rung also commits
+    // its experiments to results_manager
+    std::vector<double> evaluateRung(const std::vector<Candidate>& rung_candidates,
+                                     int rung, ResultsManager& results_manager);
+
+    void runBracket(int bracket, std::vector<Candidate> bracket_candidates,
+                    int first_rung, ResultsManager& results_manager);
+
+public:
+    ArchitectureSearch(const SweepSpec& sweep_spec, const Dataset& data,
+                       SweepRunner& sweep_runner);
+
+    // Run the configured search; survivors' full-budget experiments are
+    // added to results_manager
+    void run(ResultsManager& results_manager);
+
+    // Generations actually run vs the full grid's generation budget
+    long long generationsSpent() const { return generations_spent; }
+    long long gridGenerationBudget() const;
+
+    void printReport() const;
+    void saveLog(const std::string& filename) const;
+};
+
+#endif // SEARCH_H
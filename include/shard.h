@@ -0,0 +1,37 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <string>
+
+// One slice of a sweep split across processes: shard index of count
+// (1-based, "--shard 2/4") runs the experiments whose position in the
+// full plan is congruent to index - 1 modulo count. Each shard writes its
+// CSVs with a "#Plan_Experiments,M" first line (the full plan's size) and
+// a leading Experiment column (the plan position), which mergeShardFiles
+// uses to restore plan order and check coverage.
+struct ShardSpec {
+    int index;
+    int count;
+
+    ShardSpec() : index(1), count(1) {}
+
+    // "i/N" with 1 <= i <= N; throws std::invalid_argument otherwise
+    static ShardSpec parse(const std::string& text);
+
+    bool enabled() const { return count > 1; }
+    bool owns(int plan_index) const { return plan_index % count == index - 1; }
+
+    // "all_results.csv" -> "all_results_shard_2_of_4.csv"
+    std::string fileName(const std::string& base) const;
+};
+
+// Combine the count shard files of base (e.g. "all_results_final.csv")
+// in directory into output: rows in plan order without the Experiment
+// column, i.e. the file a single-process run writes. Throws
+// std::runtime_error if a shard is missing, headers or plan sizes differ,
+// an experiment's rows appear in more than one block or the experiments
+// do not cover the plan's 0..M-1.
+void mergeShardFiles(const std::string& directory, const std::string& base, int count,
+                     const std::string& output);
+
+#endif // SHARD_H
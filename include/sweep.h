@@ -0,0 +1,251 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <mutex>
+#include "dataset.h"
+#include "mlp.h"
+#include "ga.h"
+#include "cmaes.h"
+#include "optimizer.h"
+#include "results.h"
+#include "thread_pool.h"
+#include "arena.h"
+#include "json.h"
+#include "shard.h"
+
+enum class SearchMode {
+    GRID,                // every candidate at the full budget
+    SUCCESSIVE_HALVING,  // one bracket, keep the top 1/eta per rung
+    HYPERBAND            // several brackets trading candidates for budget
+};
+
+SearchMode parseSearchMode(const std::string& name);
+std::string searchModeName(SearchMode mode);
+
+// Multi-fidelity search over (architecture, activation) candidates. Rung
+// k of K gets max_generations / eta^(K-k) generations and num_runs /
+// eta^(K-k) runs (at least the minimums); the top 1/eta by mean
+// cross-validated test accuracy are promoted. The last rung is the full
+// budget, and only its results go to the final CSVs.
+struct SearchConfig {
+    SearchMode mode;
+    int eta;
+    int min_generations;
+    int min_runs;
+
+    SearchConfig()
+        : mode(SearchMode::GRID),
+          eta(3),
+          min_generations(10),
+          min_runs(1) {}
+};
+
+// Warm start: fold k of an experiment starts from the elites of fold k-1
+// (fold 0 from the elite bank, when one is given). This gives up strict
+// fold independence, so such results are tagged in every output file.
+struct WarmStartConfig {
+    bool enabled;
+    int elites;                  // chromosomes carried to the next fold
+    double random_fraction;      // population share kept random (diversity)
+    double perturbation;         // gene noise std dev on copies of the elites
+    std::string bank_file;       // persisted elites ("" = no bank)
+
+    WarmStartConfig()
+        : enabled(false),
+          elites(5),
+          random_fraction(0.3),
+          perturbation(0.1) {}
+};
+
+// Everything that defines a sweep. Defaults reproduce the original
+// 100-run x 34-architecture grid; a JSON spec overrides any subset:
+//
+// {
+//   "dataset": "data/wdbc.data", "folds": 10, "runs": 5, "first_run": 1,
+//   "seed": 42, "seed_stride": 1000, "threads": 0, "checkpoint_every": 10,
+//   "architectures": [[30, 10, 1], [30, 20, 10, 1]],
+//   "activations": ["sigmoid"], "optimizer": "ga", "fitness": "accuracy_margin",
+//   "ga": {"population_size": 50, "max_generations": 100, ...},
+//   "cmaes": {"initial_sigma": 0.5, ...},
+//   "stopping": {"target_fitness": 1.0, "stagnation_generations": 30, ...},
+//   "restart": {"min_gene_variance": 0.01, "min_disagreement": 0.02, "max_restarts": 3},
+//   "search": {"mode": "successive_halving", "eta": 3, "min_generations": 10},
+//   "warm_start": {"enabled": true, "elites": 5, "bank": "elite_bank.txt"},
+//   "packed_evaluation": false,
+//   "features": [{"stage": "interactions"}, {"stage": "pca", "components": 10}],
+//   "reduction": {"method": "feature_mask", "components": 10, "generations": 30},
+//   "normalization": "fold", "numa": true
+// }
+struct SweepSpec {
+    std::string dataset_path;
+    int num_folds;
+    int num_runs;
+    int first_run;               // run ids are first_run .. first_run + num_runs - 1
+    unsigned int base_seed;      // run r uses base_seed + (r - 1) * seed_stride
+    unsigned int seed_stride;
+    int threads;                 // 0 = hardware concurrency
+    int checkpoint_every;        // runs between checkpoint CSVs (0 = never)
+
+    std::vector<std::vector<int>> architectures;
+    std::vector<ActivationType> activations;
+    OptimizerType optimizer_type;
+    FitnessType fitness_type;
+    GAConfig ga_config;
+    CMAESConfig cmaes_config;
+    StoppingCriteria stopping;
+    RestartCriteria restart;
+    SearchConfig search;
+    WarmStartConfig warm_start;
+    bool packed_evaluation;      // step a run's architectures together per fold
+    FeaturePipeline features;    // cached preprocessing after normalization
+    InputReductionConfig reduction;  // per-fold, fitted on the training fold
+    bool fold_normalization;     // z-score with training-fold statistics
+                                 // instead of the whole dataset's ("fold")
+    bool numa;                   // pin workers, replicate inputs per node
+
+    // Input layer width every architecture must start with
+    int inputWidth(const Dataset& dataset) const {
+        return reduction.method == ReductionMethod::NONE ? dataset.getInputWidth()
+                                                         : reduction.components;
+    }
+
+    SweepSpec();
+
+    // Defaults overridden by the members present in json; throws
+    // std::runtime_error / std::invalid_argument on bad or unknown keys
+    static SweepSpec fromJSON(const JsonValue& json);
+    static SweepSpec fromFile(const std::string& filename);
+
+    // Check the spec against the loaded dataset (input widths etc.)
+    void validate(const Dataset& dataset) const;
+
+    unsigned int seedForRun(int run_id) const {
+        return base_seed + static_cast<unsigned int>(run_id - 1) * seed_stride;
+    }
+
+    int totalExperiments() const {
+        return num_runs * static_cast<int>(architectures.size() * activations.size());
+    }
+
+    void print() const;
+};
+
+// A point of the search space
+struct Candidate {
+    std::vector<int> architecture;
+    ActivationType activation;
+};
+
+// One cross-validated experiment of the sweep
+struct ExperimentJob {
+    int index;                   // position in the full plan (kept by shard())
+    int run_id;
+    unsigned int seed;
+    int fold_plan;               // index into SweepPlan::fold_plans
+    std::vector<int> architecture;
+    ActivationType activation;
+    int max_generations;         // generation budget (0 = the spec's)
+};
+
+// The sweep expanded into a job graph. The unit of work is one fold of
+// an experiment (or, packed, of a whole run); an experiment completes
+// when all its folds have, and a run's checkpoint when all of its
+// experiments have.
+struct SweepPlan {
+    std::vector<std::shared_ptr<const FoldPlan>> fold_plans;  // [run] shared split
+    std::vector<ExperimentJob> experiments;    // run-major, then architecture, activation
+    std::vector<int> run_end;                  // [run] one past its last experiment
+
+    static SweepPlan expand(const SweepSpec& spec, const Dataset& dataset);
+
+    // Runs first_run .. first_run + num_runs - 1 of the given candidates
+    // with a reduced generation budget (search rungs)
+    static SweepPlan expand(const SweepSpec& spec, const Dataset& dataset,
+                            const std::vector<Candidate>& candidates,
+                            int num_runs, int max_generations);
+
+    // The experiments shard owns, in plan order; runs left empty are dropped
+    SweepPlan shard(const ShardSpec& shard) const;
+};
+
+// Final elites per (architecture, activation), saved between sweeps to
+// warm-start fold 0. Text format: "<architecture> <activation> <count>
+// <length>" followed by one chromosome per line.
+class EliteBank {
+private:
+    std::map<std::string, std::vector<std::vector<double>>> entries;
+    mutable std::mutex mutex;
+
+public:
+    static std::string key(const std::vector<int>& architecture, ActivationType activation);
+
+    // load() returns false if the file does not exist; both throw
+    // std::runtime_error on a malformed or unwritable file
+    bool load(const std::string& filename);
+    void save(const std::string& filename) const;
+
+    std::vector<std::vector<double>> get(const std::string& key) const;
+    void put(const std::string& key, std::vector<std::vector<double>> elites);
+    size_t size() const;
+};
+
+// Executes a plan on the pool. All fold jobs are queued up front so the
+// workers never idle between experiments; results are committed to the
+// ResultsManager in plan order, so the output does not depend on timing.
+class SweepRunner {
+private:
+    const SweepSpec& spec;
+    const Dataset& dataset;
+    ThreadPool& pool;
+    ArenaPool& arenas;
+    EliteBank* bank;
+
+    // Optimizer for one fold of job, warm-started from seeds if non-empty
+    std::unique_ptr<Optimizer> makeOptimizer(const ExperimentJob& job, const MLP& mlp,
+                                             const SampleView& train,
+                                             const std::vector<std::vector<double>>& seeds,
+                                             std::pmr::memory_resource* resource) const;
+
+    // Score the optimizer's best on both sets (loads it into mlp)
+    FoldResult scoreFold(int fold, MLP& mlp, const Optimizer& optimizer,
+                         const SampleView& train, const SampleView& test,
+                         bool seeded, double reference_fitness) const;
+
+    // seeds warm-start the optimizer (empty = random); elites, when
+    // given, receives the final population's best for the next fold.
+    // reference_fitness is fold 0's best (negative on fold 0 itself).
+    // node is the NUMA node of the running worker, whose copies of the
+    // split and inputs are read.
+    FoldResult runFold(const SweepPlan& plan, const ExperimentJob& job,
+                       int fold, FoldArena& arena, int node,
+                       const std::vector<std::vector<double>>& seeds,
+                       std::vector<std::vector<double>>* elites,
+                       double reference_fitness) const;
+
+    // runFold for several experiments of one run at once, their
+    // populations evaluated together by a PackedMLPEvaluator
+    std::vector<FoldResult> runPackedFold(
+        const SweepPlan& plan, const std::vector<int>& experiments, int fold,
+        FoldArena& arena, int node, const std::vector<std::vector<std::vector<double>>>& seeds,
+        std::vector<std::vector<std::vector<double>>>* elites,
+        const std::vector<double>& reference_fitness) const;
+
+public:
+    SweepRunner(const SweepSpec& sweep_spec, const Dataset& data,
+                ThreadPool& thread_pool, ArenaPool& arena_pool);
+
+    // Warm-start fold 0 from bank and store each experiment's final elites
+    // in it (in plan order, so the last run wins)
+    void setEliteBank(EliteBank* elite_bank) { bank = elite_bank; }
+
+    // Checkpoints are only written for the main sweep, not search rungs.
+    // If a fold task throws, the experiments committed before it stay in
+    // results_manager and the exception is rethrown once the pool drains.
+    void run(const SweepPlan& plan, ResultsManager& results_manager,
+             bool write_checkpoints = true);
+};
+
+#endif // SWEEP_H
@@ -0,0 +1,83 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <exception>
+#include "numa.h"
+
+// Fixed-size worker pool. Tasks receive the index of the worker running
+// them so callers can keep per-worker scratch (contexts, buffers).
+//
+// NUMA-aware pools pin each worker to a CPU and keep one task queue per
+// node. A task submitted from a worker goes to that worker's node (so a
+// chain of tasks stays local); others are spread over the nodes. Workers
+// take from their own node's queue and steal across nodes only when it
+// is empty.
+//
+// A task that throws does not take the process down: the first exception
+// is kept, tasks still queued or submitted before the next wait() are
+// dropped, and wait() rethrows it to the submitter.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::vector<std::deque<std::function<void(int)>>> tasks;  // [node]
+    NumaTopology topology;
+    bool pinned;
+    std::vector<int> worker_node;  // [worker]
+    int queued;                    // tasks in all queues
+    int next_node;                 // round robin for submits from outside
+    std::atomic<long> cross_node_steals;
+    std::unique_ptr<std::atomic<int64_t>[]> busy_ns;     // [worker] time in finished tasks
+    std::unique_ptr<std::atomic<int64_t>[]> task_start;  // [worker] start of current task, 0 if idle
+    mutable std::mutex mutex;
+    std::condition_variable task_available;
+    std::condition_variable tasks_done;
+    int pending;
+    bool stopping;
+    std::exception_ptr error;      // first exception thrown by a task
+    
+    void workerLoop(int worker_id);
+    
+public:
+    explicit ThreadPool(int num_threads);
+    
+    // Pinned workers with per-node queues over topology's nodes
+    ThreadPool(int num_threads, const NumaTopology& numa_topology);
+    ~ThreadPool();
+    
+    int size() const { return static_cast<int>(workers.size()); }
+    
+    // NUMA node a worker runs on (0 unless the pool is NUMA-aware)
+    int numNodes() const { return static_cast<int>(tasks.size()); }
+    int nodeOf(int worker) const { return worker_node[worker]; }
+    const NumaTopology& getTopology() const { return topology; }
+    
+    // Tasks a worker took from another node's queue
+    long crossNodeSteals() const { return cross_node_steals.load(std::memory_order_relaxed); }
+    
+    // Tasks queued but not yet picked up by a worker
+    int queueDepth() const;
+    
+    // Total time worker has spent running tasks, including the current one
+    int64_t busyNanoseconds(int worker) const;
+    
+    // Queue a task; it runs as task(worker_id)
+    void submit(std::function<void(int)> task);
+    
+    // Block until every submitted task has finished or was dropped;
+    // rethrows (once) the first exception a task threw
+    void wait();
+    
+    // Default worker count: hardware concurrency, at least 1
+    static int defaultThreadCount();
+};
+
+#endif // THREAD_POOL_H
@@ -3,14 +3,19 @@
 
 #include <vector>
 #include <random>
+#include <string>
+#include <cstdint>
 
 namespace Utils {
-    // Random number generator
-    extern std::mt19937 rng;
+    // Random number generator (one per thread; each fold job seeds its own)
+    extern thread_local std::mt19937 rng;
     
-    // Initialize random seed
+    // Initialize random seed for the calling thread
     void initRandom(unsigned int seed = 0);
     
+    // Derive an independent seed for a sub-job (e.g. an architecture/fold)
+    unsigned int combineSeed(unsigned int seed, unsigned int value);
+    
     // Generate random double in range [min, max]
     double randomDouble(double min, double max);
     
@@ -20,6 +25,62 @@ namespace Utils {
     // Generate random vector of doubles
     std::vector<double> randomVector(int size, double min, double max);
     
+    // Layer sizes joined with '-' (e.g. "30-10-1")
+    std::string architectureName(const std::vector<int>& layers);
+    
+    // Fast xoshiro256** generator for bulk draws in hot loops
+    class FastRandom {
+    private:
+        uint64_t state[4];
+        
+    public:
+        explicit FastRandom(uint64_t seed = 0x9E3779B97F4A7C15ULL);
+        
+        void seed(uint64_t value);
+        
+        uint64_t next() {
+            const uint64_t result = rotl(state[1] * 5, 7) * 9;
+            const uint64_t t = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotl(state[3], 45);
+            return result;
+        }
+        
+        // Uniform double in [0, 1) from the top 53 bits
+        double nextDouble() {
+            return static_cast<double>(next() >> 11) * 0x1.0p-53;
+        }
+        
+        // Fill out[0..n) with uniform doubles in [min, max)
+        void fillUniform(double* out, int n, double min, double max);
+        
+        // Fill mask[0..n) with independent fair 0/1 bytes (8 bytes per draw)
+        void fillBits(uint8_t* mask, int n);
+        
+        // Standard normal sample (Marsaglia-Tsang ziggurat, 128 layers)
+        double nextGaussian();
+        
+        // Fill out[0..n) with N(mean, stddev^2) samples
+        void fillGaussian(double* out, int n, double mean, double stddev);
+        
+        // Fill out[0..n) with Cauchy(0, scale) samples
+        void fillCauchy(double* out, int n, double scale);
+        
+    private:
+        double gaussianTail(int32_t hz, int iz);
+        
+        static uint64_t rotl(uint64_t x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+    };
+    
+    // Create a FastRandom seeded from the calling thread's rng
+    FastRandom makeFastRandom();
+    
     // Shuffle vector indices
     std::vector<int> shuffleIndices(int size);
     
@@ -0,0 +1,47 @@
+#include "arena.h"
+#include <new>
+
+void* FoldArena::CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    bytes_allocated += bytes;
+    return ::operator new(bytes, std::align_val_t(alignment));
+}
+
+void FoldArena::CountingResource::do_deallocate(void* p, size_t, size_t alignment) {
+    ::operator delete(p, std::align_val_t(alignment));
+}
+
+FoldArena::FoldArena(size_t initial_bytes)
+    : block_size(initial_bytes), resets(0), regrowths(0) {
+    block.reset(new std::byte[block_size]);
+    rebuild();
+}
+
+void FoldArena::rebuild() {
+    monotonic.reset();
+    upstream.bytes_allocated = 0;
+    monotonic.reset(new std::pmr::monotonic_buffer_resource(block.get(), block_size, &upstream));
+}
+
+void FoldArena::reset() {
+    resets++;
+    
+    if (upstream.bytes_allocated == 0) {
+        // Stayed inside the block: just rewind
+        monotonic->release();
+        return;
+    }
+    
+    // Spilled: grow the block to cover the peak with some headroom
+    size_t peak = block_size + upstream.bytes_allocated;
+    monotonic.reset();
+    block_size = peak + peak / 4;
+    block.reset(new std::byte[block_size]);
+    regrowths++;
+    rebuild();
+}
+
+ArenaPool::ArenaPool(int num_workers, size_t initial_bytes) {
+    for (int i = 0; i < num_workers; i++) {
+        arenas.emplace_back(new FoldArena(initial_bytes));
+    }
+}
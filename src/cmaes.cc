@@ -0,0 +1,201 @@
+#include "cmaes.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+SepCMAES::SepCMAES(int chrom_length, const CMAESConfig& cfg,
+                   std::pmr::memory_resource* resource)
+    : Optimizer(chrom_length, cfg.verbose, resource), config(cfg),
+      mean(resource), diag_c(resource), diag_d(resource), p_sigma(resource), p_c(resource),
+      sigma(cfg.initial_sigma), batch_disagreement(0.0),
+      z_samples(resource), y_samples(resource), x_samples(resource), ranking(resource),
+      y_weighted(resource), z_weighted(resource), rank_mu_sum(resource) {
+    
+    const double n = chromosome_length;
+    lambda = config.population_size > 0 ? config.population_size
+                                        : 4 + static_cast<int>(3.0 * std::log(n));
+    if (lambda < 2) {
+        // mu = lambda / 2 parents would leave no recombination weights
+        throw std::invalid_argument("CMA-ES population_size must be at least 2, got " +
+                                    std::to_string(lambda));
+    }
+    mu = lambda / 2;
+    
+    // Log-rank recombination weights
+    weights.resize(mu);
+    for (int i = 0; i < mu; i++) {
+        weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+    }
+    double sum_w = std::accumulate(weights.begin(), weights.end(), 0.0);
+    double sum_w2 = 0.0;
+    for (auto& w : weights) {
+        w /= sum_w;
+        sum_w2 += w * w;
+    }
+    mu_eff = 1.0 / sum_w2;
+    
+    c_sigma = (mu_eff + 2.0) / (n + mu_eff + 5.0);
+    d_sigma = 1.0 + 2.0 * std::max(0.0, std::sqrt((mu_eff - 1.0) / (n + 1.0)) - 1.0) + c_sigma;
+    c_c = (4.0 + mu_eff / n) / (n + 4.0 + 2.0 * mu_eff / n);
+    
+    // Learning rates scaled up by (n + 2) / 3 for the diagonal model
+    double c1_full = 2.0 / ((n + 1.3) * (n + 1.3) + mu_eff);
+    double cmu_full = 2.0 * (mu_eff - 2.0 + 1.0 / mu_eff) / ((n + 2.0) * (n + 2.0) + mu_eff);
+    c_1 = std::min(1.0, c1_full * (n + 2.0) / 3.0);
+    c_mu = std::min(1.0 - c_1, cmu_full * (n + 2.0) / 3.0);
+    
+    chi_n = std::sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+    
+    size_t batch = static_cast<size_t>(lambda) * chromosome_length;
+    z_samples.resize(batch);
+    y_samples.resize(batch);
+    x_samples.resize(batch);
+    ranking.resize(lambda);
+    y_weighted.resize(chromosome_length);
+    z_weighted.resize(chromosome_length);
+    rank_mu_sum.resize(chromosome_length);
+}
+
+SepCMAES::~SepCMAES() {}
+
+void SepCMAES::initializeState() {
+    fast_rng = Utils::makeFastRandom();
+    
+    mean.resize(chromosome_length);
+    fast_rng.fillUniform(mean.data(), chromosome_length,
+                         -config.initial_range, config.initial_range);
+    if (!seed_chromosomes.empty()) {
+        // Warm start: centre the distribution on the best seed
+        std::copy(seed_chromosomes[0].begin(), seed_chromosomes[0].end(), mean.begin());
+    }
+    diag_c.assign(chromosome_length, 1.0);
+    diag_d.assign(chromosome_length, 1.0);
+    p_sigma.assign(chromosome_length, 0.0);
+    p_c.assign(chromosome_length, 0.0);
+    sigma = config.initial_sigma;
+    batch_disagreement = 0.0;
+}
+
+void SepCMAES::restartPopulation() {
+    if (!best_individual.chromosome.empty()) {
+        std::copy(best_individual.chromosome.begin(), best_individual.chromosome.end(),
+                  mean.begin());
+    }
+    diag_c.assign(chromosome_length, 1.0);
+    diag_d.assign(chromosome_length, 1.0);
+    p_sigma.assign(chromosome_length, 0.0);
+    p_c.assign(chromosome_length, 0.0);
+    sigma = config.initial_sigma;
+}
+
+const double* SepCMAES::ask() {
+    PROFILE_TRACE("cmaes.sample");
+    const int n = chromosome_length;
+    
+    // One batched draw for the whole population
+    fast_rng.fillGaussian(z_samples.data(), static_cast<int>(z_samples.size()), 0.0, 1.0);
+    
+    for (int k = 0; k < lambda; k++) {
+        const double* z = z_samples.data() + static_cast<size_t>(k) * n;
+        double* y = y_samples.data() + static_cast<size_t>(k) * n;
+        double* x = x_samples.data() + static_cast<size_t>(k) * n;
+        for (int i = 0; i < n; i++) {
+            y[i] = diag_d[i] * z[i];
+            x[i] = mean[i] + sigma * y[i];
+        }
+    }
+    
+    return x_samples.data();
+}
+
+void SepCMAES::processScores(const double* scores, const uint64_t* predictions) {
+    const BatchStats& stats = scoreStats(scores, lambda);
+    updateBest(x_samples.data(), stats);
+    double avg_fitness = stats.sum / lambda;
+    if (predictions) {
+        batch_disagreement = predictionDisagreement(predictions, lambda);
+    }
+    updateDistribution(scores);
+    
+    recordGeneration(avg_fitness);
+}
+
+void SepCMAES::updateDistribution(const double* scores) {
+    PROFILE_TRACE("cmaes.update");
+    const int n = chromosome_length;
+    
+    // Rank-based: best (highest fitness) first
+    std::iota(ranking.begin(), ranking.end(), 0);
+    std::stable_sort(ranking.begin(), ranking.end(),
+        [scores](int a, int b) { return scores[a] > scores[b]; });
+    
+    std::fill(y_weighted.begin(), y_weighted.end(), 0.0);
+    std::fill(z_weighted.begin(), z_weighted.end(), 0.0);
+    std::fill(rank_mu_sum.begin(), rank_mu_sum.end(), 0.0);
+    for (int r = 0; r < mu; r++) {
+        const double w = weights[r];
+        const double* y = y_samples.data() + static_cast<size_t>(ranking[r]) * n;
+        const double* z = z_samples.data() + static_cast<size_t>(ranking[r]) * n;
+        for (int i = 0; i < n; i++) {
+            y_weighted[i] += w * y[i];
+            z_weighted[i] += w * z[i];
+            rank_mu_sum[i] += w * y[i] * y[i];
+        }
+    }
+    
+    // Mean and evolution paths
+    const double ps_scale = std::sqrt(c_sigma * (2.0 - c_sigma) * mu_eff);
+    double ps_norm2 = 0.0;
+    for (int i = 0; i < n; i++) {
+        mean[i] += sigma * y_weighted[i];
+        p_sigma[i] = (1.0 - c_sigma) * p_sigma[i] + ps_scale * z_weighted[i];
+        ps_norm2 += p_sigma[i] * p_sigma[i];
+    }
+    double ps_norm = std::sqrt(ps_norm2);
+    
+    // The paths restart from zero with the population, so their age
+    // counts from the last restart
+    const int path_generation = generation - restart_generation;
+    double decay = 1.0 - std::pow(1.0 - c_sigma, 2.0 * (path_generation + 1));
+    bool h_sigma = ps_norm / std::sqrt(decay) < (1.4 + 2.0 / (n + 1.0)) * chi_n;
+    
+    const double pc_scale = h_sigma ? std::sqrt(c_c * (2.0 - c_c) * mu_eff) : 0.0;
+    const double stall_correction = h_sigma ? 0.0 : c_c * (2.0 - c_c);
+    
+    // Diagonal covariance: rank-one + rank-mu updates
+    for (int i = 0; i < n; i++) {
+        p_c[i] = (1.0 - c_c) * p_c[i] + pc_scale * y_weighted[i];
+        diag_c[i] = (1.0 - c_1 - c_mu) * diag_c[i]
+                  + c_1 * (p_c[i] * p_c[i] + stall_correction * diag_c[i])
+                  + c_mu * rank_mu_sum[i];
+        diag_d[i] = std::sqrt(diag_c[i]);
+    }
+    
+    // Cumulative step-size adaptation
+    sigma *= std::exp((c_sigma / d_sigma) * (ps_norm / chi_n - 1.0));
+}
+
+double SepCMAES::diversity() const {
+    // Mean per-coordinate standard deviation of the sampling distribution
+    double total = 0.0;
+    for (double d : diag_d) {
+        total += d;
+    }
+    return sigma * total / chromosome_length;
+}
+
+GenotypeDiversity SepCMAES::genotypeDiversity() const {
+    // Per-gene variance sigma^2 C_ii; two independent samples differ by
+    // twice the total variance in expected squared distance
+    double total = 0.0;
+    for (double c : diag_c) {
+        total += c;
+    }
+    total *= sigma * sigma;
+    GenotypeDiversity spread;
+    spread.gene_variance = total / chromosome_length;
+    spread.pairwise_distance = std::sqrt(2.0 * total);
+    return spread;
+}
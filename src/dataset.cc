@@ -1,4 +1,6 @@
 #include "dataset.h"
+#include "profiler.h"
+#include <thread>
 
 
 Dataset::Dataset() : num_samples(0), num_features(30) {}
@@ -73,6 +75,8 @@ bool Dataset::loadFromFile(const std::string& filename) {
         return false;
     }
     
+    rebuildInputs();
+    fold_plans.clear();
     std::cout << "Successfully loaded " << num_samples << " samples" << std::endl;
     return true;
 }
@@ -109,6 +113,7 @@ void Dataset::normalize() {
             features[i][j] = (features[i][j] - feature_means[j]) / feature_stds[j];
         }
     }
+    rebuildInputs();
     
     std::cout << "Data normalized using Z-score normalization" << std::endl;
 }
@@ -120,47 +125,79 @@ void Dataset::normalizeWithStats(const std::vector<double>& means,
             features[i][j] = (features[i][j] - means[j]) / stds[j];
         }
     }
+    rebuildInputs();
 }
 
-void Dataset::createKFolds(int k, unsigned int seed) {
-    fold_indices.resize(num_samples);
-    
-    std::vector<int> indices(num_samples);
-    for (int i = 0; i < num_samples; i++) {
-        indices[i] = i;
+void Dataset::rebuildInputs() {
+    inputs = FeatureMatrix::fromRows(features);
+    replicas.clear();
+}
+
+void Dataset::applyPipeline(const FeaturePipeline& pipeline) {
+    inputs = pipeline.apply(FeatureMatrix::fromRows(features));
+    replicas.clear();
+}
+
+void Dataset::replicateInputs(const NumaTopology& topology) {
+    PROFILE_TRACE("dataset.replicate");
+    replicas.clear();
+    replicas.resize(std::max(0, topology.numNodes() - 1));
+    std::vector<std::thread> threads;
+    for (int node = 1; node < topology.numNodes(); node++) {
+        threads.emplace_back([this, &topology, node]() {
+            pinCurrentThreadToNode(topology, node);
+            std::unique_ptr<InputReplica> replica(new InputReplica());
+            replica->inputs = inputs;
+            replica->labels = labels;
+            replicas[node - 1] = std::move(replica);
+        });
     }
-    
-    std::mt19937 rng(seed);
-    std::shuffle(indices.begin(), indices.end(), rng);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
 
-    for (int i = 0; i < num_samples; i++) {
-        fold_indices[indices[i]] = i % k;
+std::shared_ptr<const FoldPlan> Dataset::getFoldPlan(int k, unsigned int seed, int node) const {
+    return fold_plans.get(labels, k, seed, node);
+}
+
+const Dataset::InputReplica* Dataset::replicaFor(int node) const {
+    if (node > 0 && node <= static_cast<int>(replicas.size())) {
+        return replicas[node - 1].get();
     }
-    
-    std::cout << "Created " << k << "-fold cross validation splits" << std::endl;
+    return nullptr;
 }
 
-void Dataset::getTrainTestSplit(int test_fold,
-                                std::vector<std::vector<double>>& train_X,
-                                std::vector<int>& train_y,
-                                std::vector<std::vector<double>>& test_X,
-                                std::vector<int>& test_y) const {
-    train_X.clear();
-    train_y.clear();
-    test_X.clear();
-    test_y.clear();
-    
+SampleView Dataset::view(const std::vector<int>& rows, int node) const {
+    const InputReplica* replica = replicaFor(node);
+    return view(replica ? replica->inputs : inputs, rows, node);
+}
+
+void Dataset::reduceInputs(InputReducer& reducer, const std::vector<int>& train_rows,
+                           unsigned int seed, const InputNormalization* normalization,
+                           FeatureMatrix& reduced, int node) const {
+    PROFILE_TRACE("dataset.reduce");
+    const InputReplica* replica = replicaFor(node);
+    const FeatureMatrix& source = replica ? replica->inputs : inputs;
+    reducer.fit(view(source, train_rows, node), seed, normalization);
+    reduced.resize(num_samples, reducer.outputWidth());
     for (int i = 0; i < num_samples; i++) {
-        if (fold_indices[i] == test_fold) {
-            test_X.push_back(features[i]);
-            test_y.push_back(labels[i]);
-        } else {
-            train_X.push_back(features[i]);
-            train_y.push_back(labels[i]);
-        }
+        reducer.transform(source.row(i), reduced.row(i));
     }
 }
 
+SampleView Dataset::view(const FeatureMatrix& reduced, const std::vector<int>& rows,
+                         int node) const {
+    const InputReplica* replica = replicaFor(node);
+    SampleView v;
+    v.data = reduced.values.data();
+    v.stride = reduced.cols;
+    v.labels = replica ? replica->labels.data() : labels.data();
+    v.rows = rows.data();
+    v.count = static_cast<int>(rows.size());
+    return v;
+}
+
 void Dataset::printStatistics() const {
     std::cout << "\n===== Dataset Statistics =====" << std::endl;
     std::cout << "Number of samples: " << num_samples << std::endl;
@@ -0,0 +1,532 @@
+#include "feature_pipeline.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <random>
+
+FeatureStageType parseFeatureStageType(const std::string& name) {
+    if (name == "standardize") return FeatureStageType::STANDARDIZE;
+    if (name == "squares") return FeatureStageType::SQUARES;
+    if (name == "interactions") return FeatureStageType::INTERACTIONS;
+    if (name == "pca") return FeatureStageType::PCA;
+    throw std::invalid_argument("Unknown feature stage: " + name);
+}
+
+std::string featureStageTypeName(FeatureStageType type) {
+    switch (type) {
+        case FeatureStageType::STANDARDIZE:
+            return "standardize";
+        case FeatureStageType::SQUARES:
+            return "squares";
+        case FeatureStageType::INTERACTIONS:
+            return "interactions";
+        case FeatureStageType::PCA:
+            return "pca";
+    }
+    return "standardize";
+}
+
+namespace {
+
+// Eigen-decomposition of a symmetric matrix a (n x n, row-major) by cyclic
+// Jacobi rotations; a is destroyed, its diagonal ends up as the eigenvalues
+// and v's columns as the eigenvectors
+void jacobiEigen(std::vector<double>& a, std::vector<double>& v, int n) {
+    v.assign(static_cast<size_t>(n) * n, 0.0);
+    for (int i = 0; i < n; i++) {
+        v[static_cast<size_t>(i) * n + i] = 1.0;
+    }
+
+    for (int sweep = 0; sweep < 100; sweep++) {
+        double off = 0.0;
+        for (int p = 0; p < n; p++) {
+            for (int q = p + 1; q < n; q++) {
+                off += a[static_cast<size_t>(p) * n + q] * a[static_cast<size_t>(p) * n + q];
+            }
+        }
+        if (off < 1e-22) break;
+
+        for (int p = 0; p < n; p++) {
+            for (int q = p + 1; q < n; q++) {
+                double apq = a[static_cast<size_t>(p) * n + q];
+                if (std::fabs(apq) < 1e-300) continue;
+                double app = a[static_cast<size_t>(p) * n + p];
+                double aqq = a[static_cast<size_t>(q) * n + q];
+                double theta = (aqq - app) / (2.0 * apq);
+                double t = (theta >= 0 ? 1.0 : -1.0) /
+                           (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0);
+                double s = t * c;
+
+                for (int k = 0; k < n; k++) {
+                    double akp = a[static_cast<size_t>(k) * n + p];
+                    double akq = a[static_cast<size_t>(k) * n + q];
+                    a[static_cast<size_t>(k) * n + p] = c * akp - s * akq;
+                    a[static_cast<size_t>(k) * n + q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < n; k++) {
+                    double apk = a[static_cast<size_t>(p) * n + k];
+                    double aqk = a[static_cast<size_t>(q) * n + k];
+                    a[static_cast<size_t>(p) * n + k] = c * apk - s * aqk;
+                    a[static_cast<size_t>(q) * n + k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < n; k++) {
+                    double vkp = v[static_cast<size_t>(k) * n + p];
+                    double vkq = v[static_cast<size_t>(k) * n + q];
+                    v[static_cast<size_t>(k) * n + p] = c * vkp - s * vkq;
+                    v[static_cast<size_t>(k) * n + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+PCAProjection PCAProjection::fit(const SampleView& X, int components,
+                                 const InputNormalization* normalization) {
+    PROFILE_TRACE("features.pca");
+    const int n = X.stride;
+    const int rows = X.count;
+    std::vector<double> scratch(normalization ? n : 0);
+    auto row_at = [&](int r) {
+        if (!normalization) return X.row(r);
+        normalization->apply(X.row(r), scratch.data());
+        return static_cast<const double*>(scratch.data());
+    };
+
+    PCAProjection pca;
+    pca.mean.assign(n, 0.0);
+    for (int r = 0; r < rows; r++) {
+        const double* x = row_at(r);
+        for (int j = 0; j < n; j++) {
+            pca.mean[j] += x[j];
+        }
+    }
+    for (double& m : pca.mean) {
+        m /= std::max(rows, 1);
+    }
+
+    std::vector<double> cov(static_cast<size_t>(n) * n, 0.0);
+    std::vector<double> centered(n);
+    for (int r = 0; r < rows; r++) {
+        const double* x = row_at(r);
+        for (int j = 0; j < n; j++) {
+            centered[j] = x[j] - pca.mean[j];
+        }
+        for (int i = 0; i < n; i++) {
+            double ci = centered[i];
+            double* row = cov.data() + static_cast<size_t>(i) * n;
+            for (int j = i; j < n; j++) {
+                row[j] += ci * centered[j];
+            }
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = i; j < n; j++) {
+            double c = cov[static_cast<size_t>(i) * n + j] / std::max(rows - 1, 1);
+            cov[static_cast<size_t>(i) * n + j] = c;
+            cov[static_cast<size_t>(j) * n + i] = c;
+        }
+    }
+
+    std::vector<double> vectors;
+    jacobiEigen(cov, vectors, n);
+
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return cov[static_cast<size_t>(a) * n + a] > cov[static_cast<size_t>(b) * n + b];
+    });
+
+    components = std::min(components, n);
+    for (int c = 0; c < components; c++) {
+        int k = order[c];
+        std::vector<double> axis(n);
+        for (int i = 0; i < n; i++) {
+            axis[i] = vectors[static_cast<size_t>(i) * n + k];
+        }
+        // Fix the sign so the largest loading is positive (deterministic output)
+        int largest = static_cast<int>(std::max_element(axis.begin(), axis.end(),
+            [](double a, double b) { return std::fabs(a) < std::fabs(b); }) - axis.begin());
+        if (axis[largest] < 0.0) {
+            for (double& value : axis) value = -value;
+        }
+        pca.axes.push_back(axis);
+        pca.variances.push_back(cov[static_cast<size_t>(k) * n + k]);
+    }
+
+    // a . ((x - m) s - mu) = (a s) . (x - (m + mu / s))
+    if (normalization) {
+        for (int i = 0; i < n; i++) {
+            pca.mean[i] = normalization->mean[i] + pca.mean[i] / normalization->inv_std[i];
+        }
+        for (std::vector<double>& axis : pca.axes) {
+            for (int i = 0; i < n; i++) {
+                axis[i] *= normalization->inv_std[i];
+            }
+        }
+    }
+    return pca;
+}
+
+void PCAProjection::project(const double* row, double* out) const {
+    const int n = static_cast<int>(mean.size());
+    for (size_t c = 0; c < axes.size(); c++) {
+        const double* axis = axes[c].data();
+        double sum = 0.0;
+        for (int i = 0; i < n; i++) {
+            sum += (row[i] - mean[i]) * axis[i];
+        }
+        out[c] = sum;
+    }
+}
+
+FeaturePipeline FeaturePipeline::fromJSON(const JsonValue& json) {
+    FeaturePipeline pipeline;
+    for (const auto& item : json.asArray()) {
+        item.checkKeys({"stage", "components"}, "features");
+        FeatureStage stage;
+        stage.type = parseFeatureStageType(item["stage"].asString());
+        stage.components = item.getInt("components", stage.components);
+        if (stage.type == FeatureStageType::PCA && stage.components < 1) {
+            throw std::invalid_argument("pca needs at least 1 component");
+        }
+        pipeline.stages.push_back(stage);
+    }
+    return pipeline;
+}
+
+bool FeaturePipeline::fitsStatistics() const {
+    for (const FeatureStage& stage : stages) {
+        if (stage.type == FeatureStageType::STANDARDIZE || stage.type == FeatureStageType::PCA) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int FeaturePipeline::outputWidth(int input_width) const {
+    int width = input_width;
+    for (const FeatureStage& stage : stages) {
+        switch (stage.type) {
+            case FeatureStageType::STANDARDIZE:
+                break;
+            case FeatureStageType::SQUARES:
+                width *= 2;
+                break;
+            case FeatureStageType::INTERACTIONS:
+                width += width * (width - 1) / 2;
+                break;
+            case FeatureStageType::PCA:
+                width = std::min(width, stage.components);
+                break;
+        }
+    }
+    return width;
+}
+
+FeatureMatrix FeaturePipeline::apply(const FeatureMatrix& input) const {
+    PROFILE_TRACE("features.pipeline");
+    FeatureMatrix current = input;
+    for (const FeatureStage& stage : stages) {
+        const int rows = current.rows;
+        const int n = current.cols;
+        FeatureMatrix next;
+
+        switch (stage.type) {
+            case FeatureStageType::STANDARDIZE: {
+                next = current;
+                for (int j = 0; j < n; j++) {
+                    double sum = 0.0, sum_sq = 0.0;
+                    for (int r = 0; r < rows; r++) {
+                        sum += current.row(r)[j];
+                    }
+                    double mean = sum / std::max(rows, 1);
+                    for (int r = 0; r < rows; r++) {
+                        double diff = current.row(r)[j] - mean;
+                        sum_sq += diff * diff;
+                    }
+                    double sd = std::sqrt(sum_sq / std::max(rows, 1));
+                    if (sd < 1e-10) sd = 1.0;
+                    for (int r = 0; r < rows; r++) {
+                        next.row(r)[j] = (current.row(r)[j] - mean) / sd;
+                    }
+                }
+                break;
+            }
+            case FeatureStageType::SQUARES: {
+                next.resize(rows, 2 * n);
+                for (int r = 0; r < rows; r++) {
+                    const double* x = current.row(r);
+                    double* out = next.row(r);
+                    for (int j = 0; j < n; j++) {
+                        out[j] = x[j];
+                        out[n + j] = x[j] * x[j];
+                    }
+                }
+                break;
+            }
+            case FeatureStageType::INTERACTIONS: {
+                next.resize(rows, n + n * (n - 1) / 2);
+                for (int r = 0; r < rows; r++) {
+                    const double* x = current.row(r);
+                    double* out = next.row(r);
+                    std::copy(x, x + n, out);
+                    int k = n;
+                    for (int i = 0; i < n; i++) {
+                        for (int j = i + 1; j < n; j++) {
+                            out[k++] = x[i] * x[j];
+                        }
+                    }
+                }
+                break;
+            }
+            case FeatureStageType::PCA: {
+                PCAProjection pca = PCAProjection::fit(
+                    SampleView(current, static_cast<const int*>(nullptr)), stage.components);
+                next.resize(rows, pca.outputWidth());
+                for (int r = 0; r < rows; r++) {
+                    pca.project(current.row(r), next.row(r));
+                }
+                break;
+            }
+        }
+        current = std::move(next);
+    }
+    return current;
+}
+
+std::string FeaturePipeline::describe() const {
+    std::string text;
+    for (const FeatureStage& stage : stages) {
+        if (!text.empty()) text += " -> ";
+        text += featureStageTypeName(stage.type);
+        if (stage.type == FeatureStageType::PCA) {
+            text += "(" + std::to_string(stage.components) + ")";
+        }
+    }
+    return text.empty() ? "none" : text;
+}
+
+InputNormalization InputNormalization::fit(const SampleView& train) {
+    PROFILE_TRACE("features.fold_stats");
+    const int n = train.stride;
+    InputNormalization norm;
+    norm.mean.assign(n, 0.0);
+    norm.inv_std.assign(n, 1.0);
+    if (train.count == 0) return norm;
+
+    // Sums of x - shift and its square, shifted by the first row
+    const double* shift = train.row(0);
+    std::vector<double> sum(n, 0.0), sum_sq(n, 0.0);
+    for (int r = 0; r < train.count; r++) {
+        const double* x = train.row(r);
+        for (int j = 0; j < n; j++) {
+            const double d = x[j] - shift[j];
+            sum[j] += d;
+            sum_sq[j] += d * d;
+        }
+    }
+    for (int j = 0; j < n; j++) {
+        const double m = sum[j] / train.count;
+        const double var = std::max(sum_sq[j] / train.count - m * m, 0.0);
+        const double sd = std::sqrt(var);
+        norm.mean[j] = shift[j] + m;
+        norm.inv_std[j] = sd < 1e-10 ? 1.0 : 1.0 / sd;
+    }
+    return norm;
+}
+
+void InputNormalization::apply(const double* row, double* out) const {
+    for (size_t j = 0; j < mean.size(); j++) {
+        out[j] = (row[j] - mean[j]) * inv_std[j];
+    }
+}
+
+ReductionMethod parseReductionMethod(const std::string& name) {
+    if (name == "none") return ReductionMethod::NONE;
+    if (name == "pca") return ReductionMethod::PCA;
+    if (name == "feature_mask") return ReductionMethod::FEATURE_MASK;
+    throw std::invalid_argument("Unknown input reduction: " + name);
+}
+
+std::string reductionMethodName(ReductionMethod method) {
+    switch (method) {
+        case ReductionMethod::NONE:
+            return "none";
+        case ReductionMethod::PCA:
+            return "pca";
+        case ReductionMethod::FEATURE_MASK:
+            return "feature_mask";
+    }
+    return "none";
+}
+
+void InputReducer::fit(const SampleView& train, unsigned int seed,
+                       const InputNormalization* normalization) {
+    PROFILE_TRACE("features.reduce_fit");
+    if (config.method == ReductionMethod::PCA) {
+        pca = PCAProjection::fit(train, config.components, normalization);
+    } else if (config.method == ReductionMethod::FEATURE_MASK) {
+        fitMask(train, seed, normalization);
+    }
+}
+
+namespace {
+
+// Resubstitution accuracy of a nearest-centroid classifier on the masked
+// inputs (z-scored on the fly by normalization, if given), plus a margin
+// term below 1/n to break ties
+double centroidFitness(const SampleView& train, const std::vector<int>& mask,
+                       const InputNormalization* normalization) {
+    const int k = static_cast<int>(mask.size());
+    auto value = [normalization](const double* x, int f) {
+        return normalization ? (x[f] - normalization->mean[f]) * normalization->inv_std[f]
+                             : x[f];
+    };
+    std::vector<double> centroid[2] = {std::vector<double>(k, 0.0), std::vector<double>(k, 0.0)};
+    int counts[2] = {0, 0};
+    for (int r = 0; r < train.count; r++) {
+        const double* x = train.row(r);
+        int label = train.label(r) ? 1 : 0;
+        counts[label]++;
+        for (int j = 0; j < k; j++) {
+            centroid[label][j] += value(x, mask[j]);
+        }
+    }
+    for (int c = 0; c < 2; c++) {
+        for (double& value : centroid[c]) {
+            value /= std::max(counts[c], 1);
+        }
+    }
+
+    int correct = 0;
+    double margin_sum = 0.0;
+    for (int r = 0; r < train.count; r++) {
+        const double* x = train.row(r);
+        double d[2] = {0.0, 0.0};
+        for (int c = 0; c < 2; c++) {
+            for (int j = 0; j < k; j++) {
+                double diff = value(x, mask[j]) - centroid[c][j];
+                d[c] += diff * diff;
+            }
+        }
+        int label = train.label(r) ? 1 : 0;
+        double margin = d[1 - label] - d[label];
+        if (margin > 0.0) correct++;
+        margin_sum += std::tanh(margin);
+    }
+    const double n = std::max(train.count, 1);
+    return (correct + 0.5 * (margin_sum / n + 1.0)) / n;
+}
+
+} // namespace
+
+void InputReducer::fitMask(const SampleView& train, unsigned int seed,
+                           const InputNormalization* normalization) {
+    const int n = train.stride;
+    const int k = std::min(config.components, n);
+    const int pop = std::max(config.mask_population, 4);
+    std::mt19937 rng(seed);
+
+    auto randomMask = [&]() {
+        std::vector<int> all(n);
+        std::iota(all.begin(), all.end(), 0);
+        std::shuffle(all.begin(), all.end(), rng);
+        std::vector<int> m(all.begin(), all.begin() + k);
+        std::sort(m.begin(), m.end());
+        return m;
+    };
+
+    std::vector<std::vector<int>> population(pop);
+    std::vector<double> fitness(pop);
+    for (int i = 0; i < pop; i++) {
+        population[i] = randomMask();
+        fitness[i] = centroidFitness(train, population[i], normalization);
+    }
+
+    std::uniform_int_distribution<int> pick(0, pop - 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto tournament = [&]() {
+        int a = pick(rng), b = pick(rng);
+        return fitness[a] >= fitness[b] ? a : b;
+    };
+
+    for (int gen = 0; gen < config.mask_generations; gen++) {
+        std::vector<int> order(pop);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](int a, int b) { return fitness[a] > fitness[b]; });
+
+        // Two elites survive; children draw k inputs from their parents' union
+        std::vector<std::vector<int>> next = {population[order[0]], population[order[1]]};
+        while (static_cast<int>(next.size()) < pop) {
+            const std::vector<int>& p1 = population[tournament()];
+            const std::vector<int>& p2 = population[tournament()];
+            std::vector<int> pool;
+            std::set_union(p1.begin(), p1.end(), p2.begin(), p2.end(), std::back_inserter(pool));
+            std::shuffle(pool.begin(), pool.end(), rng);
+            std::vector<int> child(pool.begin(), pool.begin() + k);
+
+            // Mutation: swap one selected input for an unselected one
+            if (unit(rng) < 0.3 && k < n) {
+                std::vector<bool> used(n, false);
+                for (int j : child) used[j] = true;
+                int out = std::uniform_int_distribution<int>(0, k - 1)(rng);
+                int in;
+                do {
+                    in = std::uniform_int_distribution<int>(0, n - 1)(rng);
+                } while (used[in]);
+                child[out] = in;
+            }
+            std::sort(child.begin(), child.end());
+            next.push_back(child);
+        }
+
+        population = std::move(next);
+        for (int i = 0; i < pop; i++) {
+            fitness[i] = centroidFitness(train, population[i], normalization);
+        }
+    }
+
+    int best = static_cast<int>(std::max_element(fitness.begin(), fitness.end()) - fitness.begin());
+    mask = population[best];
+    mask_mean.assign(k, 0.0);
+    mask_scale.assign(k, 1.0);
+    if (normalization) {
+        for (int j = 0; j < k; j++) {
+            mask_mean[j] = normalization->mean[mask[j]];
+            mask_scale[j] = normalization->inv_std[mask[j]];
+        }
+    }
+}
+
+void InputReducer::transform(const double* row, double* out) const {
+    switch (config.method) {
+        case ReductionMethod::PCA:
+            pca.project(row, out);
+            break;
+        case ReductionMethod::FEATURE_MASK:
+            for (size_t j = 0; j < mask.size(); j++) {
+                out[j] = (row[mask[j]] - mask_mean[j]) * mask_scale[j];
+            }
+            break;
+        case ReductionMethod::NONE:
+            break;
+    }
+}
+
+std::string InputReducer::describe() const {
+    if (config.method == ReductionMethod::PCA) {
+        return "pca" + std::to_string(config.components);
+    }
+    std::string text;
+    for (int j : mask) {
+        if (!text.empty()) text += ";";
+        text += std::to_string(j);
+    }
+    return text;
+}
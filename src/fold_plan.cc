@@ -0,0 +1,58 @@
+#include "fold_plan.h"
+#include "profiler.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+FoldPlan::FoldPlan(const std::vector<int>& labels, int num_folds, unsigned int split_seed)
+    : k(num_folds), seed(split_seed), assignment(labels.size()),
+      train_rows(num_folds), test_rows(num_folds) {
+    PROFILE_TRACE("dataset.fold_plan");
+    const int n = static_cast<int>(labels.size());
+    if (k < 2 || k > n) {
+        throw std::invalid_argument("fold count must be in [2, number of samples]");
+    }
+
+    // Samples of each class, in class order
+    std::map<int, std::vector<int>> by_class;
+    for (int i = 0; i < n; i++) {
+        by_class[labels[i]].push_back(i);
+    }
+
+    std::mt19937 rng(seed);
+    int next = 0;
+    for (auto& entry : by_class) {
+        std::vector<int>& members = entry.second;
+        std::shuffle(members.begin(), members.end(), rng);
+        for (int i : members) {
+            assignment[i] = next;
+            next = (next + 1) % k;
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        for (int fold = 0; fold < k; fold++) {
+            (assignment[i] == fold ? test_rows : train_rows)[fold].push_back(i);
+        }
+    }
+}
+
+std::shared_ptr<const FoldPlan> FoldPlanCache::get(const std::vector<int>& labels,
+                                                   int k, unsigned int seed, int node) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const FoldPlan>& plan = plans[std::make_tuple(k, seed, node)];
+    if (!plan) {
+        plan = std::make_shared<const FoldPlan>(labels, k, seed);
+    }
+    return plan;
+}
+
+void FoldPlanCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    plans.clear();
+}
+
+size_t FoldPlanCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return plans.size();
+}
@@ -1,223 +1,436 @@
 #include "ga.h"
 #include "utils.h"
+#include "profiler.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
+#include <numeric>
 
-GeneticAlgorithm::GeneticAlgorithm(int chrom_length, const GAConfig& cfg)
-    : config(cfg), chromosome_length(chrom_length), best_fitness(0.0) {
+GeneticAlgorithm::GeneticAlgorithm(int chrom_length, const GAConfig& cfg,
+                                   std::pmr::memory_resource* resource)
+    : Optimizer(chrom_length, cfg.verbose, resource), config(cfg), initial_batch(true),
+      genes(resource), fitness(resource),
+      offspring_genes(resource), offspring_fitness(resource),
+      next_genes(resource), next_fitness(resource), fitness_sum(0.0),
+      phenotypes(resource), offspring_phenotypes(resource), next_phenotypes(resource),
+      gene_sum(resource), gene_sum_sq(resource),
+      parent_indices(resource), population_order(resource), offspring_order(resource),
+      crossover_mask(resource),
+      step_sizes(resource), offspring_step_sizes(resource), next_step_sizes(resource),
+      refine_genes(resource), refine_scores(resource), refine_phenotypes(resource) {
     
-    population.resize(config.population_size);
-    for (auto& ind : population) {
-        ind.chromosome.resize(chromosome_length);
+    size_t arena_size = static_cast<size_t>(config.population_size) * chromosome_length;
+    genes.resize(arena_size);
+    fitness.resize(config.population_size, 0.0);
+    offspring_genes.resize(arena_size);
+    offspring_fitness.resize(config.population_size, 0.0);
+    next_genes.resize(arena_size);
+    next_fitness.resize(config.population_size, 0.0);
+    gene_sum.resize(chromosome_length);
+    gene_sum_sq.resize(chromosome_length);
+    
+    // Parents are drawn in pairs, so round up for odd population sizes
+    int num_pairs = (config.population_size + 1) / 2;
+    parent_indices.resize(num_pairs * 2);
+    population_order.resize(config.population_size);
+    offspring_order.resize(config.population_size);
+    crossover_mask.resize(static_cast<size_t>(num_pairs) * chromosome_length);
+    MutationParams mutation_params;
+    mutation_params.type = config.mutation_type;
+    mutation_params.rate = config.mutation_rate;
+    mutation_params.strength = config.mutation_strength;
+    mutation_params.min_step = config.min_step_size;
+    mutation_operator = createMutationOperator(mutation_params);
+    
+    if (mutation_operator->usesStepSizes()) {
+        step_sizes.resize(arena_size);
+        offspring_step_sizes.resize(arena_size);
+        next_step_sizes.resize(arena_size);
     }
 }
 
 GeneticAlgorithm::~GeneticAlgorithm() {}
 
-void GeneticAlgorithm::setFitnessFunction(
-    std::function<double(const std::vector<double>&)> func) {
-    fitness_function = func;
-}
-
 void GeneticAlgorithm::initializePopulation(double min_val, double max_val) {
-    for (auto& individual : population) {
-        individual.chromosome = Utils::randomVector(chromosome_length, min_val, max_val);
-        individual.fitness = 0.0;
-    }
+    fast_rng = Utils::makeFastRandom();
+    fast_rng.fillUniform(genes.data(), static_cast<int>(genes.size()), min_val, max_val);
+    std::fill(fitness.begin(), fitness.end(), 0.0);
+    std::fill(step_sizes.begin(), step_sizes.end(), config.mutation_strength);
+    seedPopulation();
 }
 
-void GeneticAlgorithm::evaluateFitness() {
-    for (auto& individual : population) {
-        individual.fitness = fitness_function(individual.chromosome);
-    }
+void GeneticAlgorithm::seedPopulation() {
+    if (seed_chromosomes.empty()) return;
     
-    // Update best individual
-    auto best_it = std::max_element(population.begin(), population.end(),
-        [](const Individual& a, const Individual& b) {
-            return a.fitness < b.fitness;
-        });
+    // Seeds first, then perturbed copies; the random tail keeps diversity
+    const int n = chromosome_length;
+    const int num_seeds = static_cast<int>(seed_chromosomes.size());
+    int random_count = static_cast<int>(std::lround(seed_random_fraction * config.population_size));
+    int seeded = std::max(std::min(num_seeds, config.population_size),
+                          config.population_size - random_count);
     
-    if (best_it->fitness > best_fitness) {
-        best_fitness = best_it->fitness;
-        best_individual = *best_it;
+    for (int i = 0; i < seeded; i++) {
+        const std::vector<double>& seed = seed_chromosomes[i % num_seeds];
+        double* dst = chromosomeAt(genes, i);
+        std::copy(seed.begin(), seed.end(), dst);
+        if (i >= num_seeds && seed_perturbation > 0.0) {
+            for (int j = 0; j < n; j++) {
+                dst[j] += seed_perturbation * fast_rng.nextGaussian();
+            }
+        }
     }
 }
 
-Individual GeneticAlgorithm::tournamentSelection() {
-    Individual best;
-    best.fitness = -1.0;
+int GeneticAlgorithm::tournamentSelection() {
+    int best = -1;
+    double best_fit = -1.0;
     
     for (int i = 0; i < config.tournament_size; i++) {
-        int idx = Utils::randomInt(0, population.size() - 1);
-        if (population[idx].fitness > best.fitness) {
-            best = population[idx];
+        int idx = Utils::randomInt(0, config.population_size - 1);
+        if (fitness[idx] > best_fit) {
+            best_fit = fitness[idx];
+            best = idx;
         }
     }
     
     return best;
 }
 
-std::pair<Individual, Individual> GeneticAlgorithm::crossover(
-    const Individual& parent1, const Individual& parent2) {
+void GeneticAlgorithm::selectParents() {
+    PROFILE_TRACE("ga.selection");
+    for (auto& idx : parent_indices) {
+        idx = tournamentSelection();
+    }
+}
+
+void GeneticAlgorithm::crossoverPopulation() {
+    PROFILE_TRACE("ga.crossover");
+    const int n = chromosome_length;
+    const int num_pairs = static_cast<int>(parent_indices.size() / 2);
+    const bool with_steps = !step_sizes.empty();
     
-    Individual child1 = parent1;
-    Individual child2 = parent2;
+    // One bulk draw of swap masks for every pair
+    fast_rng.fillBits(crossover_mask.data(), static_cast<int>(crossover_mask.size()));
     
-    if (Utils::randomDouble(0.0, 1.0) < config.crossover_rate) {
-        // Uniform crossover
-        for (int i = 0; i < chromosome_length; i++) {
-            if (Utils::randomDouble(0.0, 1.0) < 0.5) {
-                child1.chromosome[i] = parent2.chromosome[i];
-                child2.chromosome[i] = parent1.chromosome[i];
+    for (int pair = 0; pair < num_pairs; pair++) {
+        int p1_idx = parent_indices[2 * pair];
+        int p2_idx = parent_indices[2 * pair + 1];
+        int c1_idx = 2 * pair;
+        // Odd population: the last pair only keeps its first child
+        bool has_c2 = 2 * pair + 1 < config.population_size;
+        int c2_idx = has_c2 ? 2 * pair + 1 : c1_idx;
+        
+        if (fast_rng.nextDouble() < config.crossover_rate) {
+            // Uniform crossover as a branchless blend
+            const uint8_t* mask = crossover_mask.data() + static_cast<size_t>(pair) * n;
+            blendPair(genes, offspring_genes, mask, p1_idx, p2_idx, c1_idx, c2_idx, has_c2);
+            if (with_steps) {
+                blendPair(step_sizes, offspring_step_sizes, mask,
+                          p1_idx, p2_idx, c1_idx, c2_idx, has_c2);
             }
+        } else {
+            copyChromosome(genes, p1_idx, offspring_genes, c1_idx);
+            if (has_c2) copyChromosome(genes, p2_idx, offspring_genes, c2_idx);
+            if (with_steps) {
+                copyChromosome(step_sizes, p1_idx, offspring_step_sizes, c1_idx);
+                if (has_c2) copyChromosome(step_sizes, p2_idx, offspring_step_sizes, c2_idx);
+            }
+        }
+    }
+}
+
+void GeneticAlgorithm::blendPair(std::pmr::vector<double>& parents,
+                                 std::pmr::vector<double>& children,
+                                 const uint8_t* mask, int p1_idx, int p2_idx,
+                                 int c1_idx, int c2_idx, bool has_c2) {
+    const int n = chromosome_length;
+    const double* p1 = chromosomeAt(parents, p1_idx);
+    const double* p2 = chromosomeAt(parents, p2_idx);
+    double* c1 = chromosomeAt(children, c1_idx);
+    
+    if (!has_c2) {
+        for (int i = 0; i < n; i++) {
+            c1[i] = mask[i] ? p2[i] : p1[i];
         }
+        return;
     }
     
-    return {child1, child2};
+    double* c2 = chromosomeAt(children, c2_idx);
+    for (int i = 0; i < n; i++) {
+        double a = p1[i];
+        double b = p2[i];
+        bool swap = mask[i] != 0;
+        c1[i] = swap ? b : a;
+        c2[i] = swap ? a : b;
+    }
 }
 
-void GeneticAlgorithm::mutate(Individual& individual) {
+void GeneticAlgorithm::copyChromosome(std::pmr::vector<double>& src_arena, int src_idx,
+                                      std::pmr::vector<double>& dst_arena, int dst_idx) {
+    const double* src = chromosomeAt(src_arena, src_idx);
+    std::copy(src, src + chromosome_length, chromosomeAt(dst_arena, dst_idx));
+}
+
+void GeneticAlgorithm::copyPhenotype(std::pmr::vector<uint64_t>& src_arena, int src_idx,
+                                     std::pmr::vector<uint64_t>& dst_arena, int dst_idx) {
+    const size_t words = phenotype_words;
+    std::copy(src_arena.begin() + src_idx * words, src_arena.begin() + (src_idx + 1) * words,
+              dst_arena.begin() + dst_idx * words);
+}
+
+void GeneticAlgorithm::addToGenotype(const double* chromosome) {
     for (int i = 0; i < chromosome_length; i++) {
-        if (Utils::randomDouble(0.0, 1.0) < config.mutation_rate) {
-            // Gaussian mutation
-            double noise = Utils::randomDouble(-config.mutation_strength, 
-                                              config.mutation_strength);
-            individual.chromosome[i] += noise;
-            
-            // Clamp to reasonable range
-            individual.chromosome[i] = Utils::clamp(individual.chromosome[i], -5.0, 5.0);
-        }
+        gene_sum[i] += chromosome[i];
+        gene_sum_sq[i] += chromosome[i] * chromosome[i];
     }
 }
 
-void GeneticAlgorithm::replacePopulation(std::vector<Individual>& offspring) {
-    // Sort by fitness (descending)
-    std::sort(population.begin(), population.end(),
-        [](const Individual& a, const Individual& b) {
-            return a.fitness > b.fitness;
-        });
+void GeneticAlgorithm::accumulateGenotype() {
+    // Full recount (initial population, refinements)
+    std::fill(gene_sum.begin(), gene_sum.end(), 0.0);
+    std::fill(gene_sum_sq.begin(), gene_sum_sq.end(), 0.0);
+    for (int ind = 0; ind < config.population_size; ind++) {
+        addToGenotype(chromosomeAt(genes, ind));
+    }
+}
+
+void GeneticAlgorithm::mutatePopulation() {
+    PROFILE_TRACE("ga.mutation");
+    double* steps = step_sizes.empty() ? nullptr : offspring_step_sizes.data();
+    mutation_operator->apply(offspring_genes.data(), steps, config.population_size,
+                             chromosome_length, fast_rng);
+}
+
+void GeneticAlgorithm::replacePopulation() {
+    PROFILE_TRACE("ga.replacement");
+    // Sort by fitness (descending), on indices rather than chromosomes
+    std::pmr::vector<int>& pop_order = population_order;
+    std::pmr::vector<int>& off_order = offspring_order;
+    std::iota(pop_order.begin(), pop_order.end(), 0);
+    std::iota(off_order.begin(), off_order.end(), 0);
     
-    std::sort(offspring.begin(), offspring.end(),
-        [](const Individual& a, const Individual& b) {
-            return a.fitness > b.fitness;
-        });
+    std::stable_sort(pop_order.begin(), pop_order.end(),
+        [this](int a, int b) { return fitness[a] > fitness[b]; });
+    std::stable_sort(off_order.begin(), off_order.end(),
+        [this](int a, int b) { return offspring_fitness[a] > offspring_fitness[b]; });
     
     // Elitism: keep top individuals
-    int elites = static_cast<int>(config.population_size * config.elitism_rate);
+    int elites = eliteCount();
     
-    std::vector<Individual> new_population;
-    new_population.reserve(config.population_size);
+    // The generation's average and gene sums are taken on the way, in
+    // slot order
+    const bool with_steps = !step_sizes.empty();
+    const bool with_phenotypes = phenotype_words > 0;
+    fitness_sum = 0.0;
+    std::fill(gene_sum.begin(), gene_sum.end(), 0.0);
+    std::fill(gene_sum_sq.begin(), gene_sum_sq.end(), 0.0);
+    int slot = 0;
+    for (int i = 0; i < elites; i++, slot++) {
+        copyChromosome(genes, pop_order[i], next_genes, slot);
+        if (with_steps) copyChromosome(step_sizes, pop_order[i], next_step_sizes, slot);
+        if (with_phenotypes) copyPhenotype(phenotypes, pop_order[i], next_phenotypes, slot);
+        next_fitness[slot] = fitness[pop_order[i]];
+        fitness_sum += next_fitness[slot];
+        addToGenotype(chromosomeAt(next_genes, slot));
+    }
     
-    // Add elites
-    for (int i = 0; i < elites && i < static_cast<int>(population.size()); i++) {
-        new_population.push_back(population[i]);
+    // Fill the rest with the best offspring
+    for (int i = 0; slot < config.population_size; i++, slot++) {
+        copyChromosome(offspring_genes, off_order[i], next_genes, slot);
+        if (with_steps) {
+            copyChromosome(offspring_step_sizes, off_order[i], next_step_sizes, slot);
+        }
+        if (with_phenotypes) {
+            copyPhenotype(offspring_phenotypes, off_order[i], next_phenotypes, slot);
+        }
+        next_fitness[slot] = offspring_fitness[off_order[i]];
+        fitness_sum += next_fitness[slot];
+        addToGenotype(chromosomeAt(next_genes, slot));
     }
     
-    // Add offspring
-    for (size_t i = 0; i < offspring.size() && 
-         new_population.size() < static_cast<size_t>(config.population_size); i++) {
-        new_population.push_back(offspring[i]);
+    genes.swap(next_genes);
+    fitness.swap(next_fitness);
+    step_sizes.swap(next_step_sizes);
+    phenotypes.swap(next_phenotypes);
+}
+
+void GeneticAlgorithm::initializeState() {
+    initializePopulation();
+    size_t words = static_cast<size_t>(config.population_size) * phenotype_words;
+    phenotypes.assign(words, 0);
+    offspring_phenotypes.assign(words, 0);
+    next_phenotypes.assign(words, 0);
+    initial_batch = true;
+}
+
+void GeneticAlgorithm::restartPopulation() {
+    const int pop = config.population_size;
+    const int keep = std::min(std::max(eliteCount(), 1), pop);
+    
+    std::pmr::vector<int>& order = population_order;
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+        [this](int a, int b) { return fitness[a] > fitness[b]; });
+    
+    const bool with_steps = !step_sizes.empty();
+    for (int i = 0; i < keep; i++) {
+        copyChromosome(genes, order[i], next_genes, i);
+        if (with_steps) copyChromosome(step_sizes, order[i], next_step_sizes, i);
     }
+    genes.swap(next_genes);
+    step_sizes.swap(next_step_sizes);
     
-    population = new_population;
+    const size_t kept = static_cast<size_t>(keep) * chromosome_length;
+    fast_rng.fillUniform(genes.data() + kept, static_cast<int>(genes.size() - kept), -1.0, 1.0);
+    std::fill(step_sizes.begin() + (with_steps ? kept : 0), step_sizes.end(),
+              config.mutation_strength);
+    initial_batch = true;
 }
 
-void GeneticAlgorithm::evolve() {
-    if (!fitness_function) {
-        throw std::runtime_error("Fitness function not set");
+const double* GeneticAlgorithm::ask() {
+    if (initial_batch) {
+        return genes.data();
     }
     
-    // Initialize
-    initializePopulation();
-    evaluateFitness();
+    // Create offspring
+    selectParents();
+    crossoverPopulation();
+    mutatePopulation();
+    return offspring_genes.data();
+}
+
+int GeneticAlgorithm::eliteCount() const {
+    int elites = static_cast<int>(config.population_size * config.elitism_rate);
+    return std::min(elites, config.population_size);
+}
+
+void GeneticAlgorithm::processScores(const double* scores, const uint64_t* predictions) {
+    const BatchStats& stats = scoreStats(scores, config.population_size);
+    const size_t words = static_cast<size_t>(config.population_size) * phenotype_words;
+    if (initial_batch) {
+        std::copy(scores, scores + config.population_size, fitness.begin());
+        if (predictions) std::copy(predictions, predictions + words, phenotypes.begin());
+        updateBest(genes.data(), stats);
+        accumulateGenotype();
+        initial_batch = false;
+        checkStopping();
+        return;
+    }
     
-    if (config.verbose) {
-        std::cout << "\n=== Starting Genetic Algorithm ===\n";
-        std::cout << "Population size: " << config.population_size << "\n";
-        std::cout << "Max generations: " << config.max_generations << "\n";
-        std::cout << "Chromosome length: " << chromosome_length << "\n\n";
+    // Elites were already counted; the best offspring always enters the
+    // population unless elitism fills it
+    std::copy(scores, scores + config.population_size, offspring_fitness.begin());
+    if (predictions) std::copy(predictions, predictions + words, offspring_phenotypes.begin());
+    if (eliteCount() < config.population_size) {
+        updateBest(offspring_genes.data(), stats);
     }
     
-    // Evolution loop
-    for (int gen = 0; gen < config.max_generations; gen++) {
-        // Create offspring
-        std::vector<Individual> offspring;
-        offspring.reserve(config.population_size);
-        
-        while (offspring.size() < static_cast<size_t>(config.population_size)) {
-            // Selection
-            Individual parent1 = tournamentSelection();
-            Individual parent2 = tournamentSelection();
-            
-            // Crossover
-            auto [child1, child2] = crossover(parent1, parent2);
-            
-            // Mutation
-            mutate(child1);
-            mutate(child2);
-            
-            offspring.push_back(child1);
-            if (offspring.size() < static_cast<size_t>(config.population_size)) {
-                offspring.push_back(child2);
-            }
-        }
-        
-        // Evaluate offspring
-        for (auto& individual : offspring) {
-            individual.fitness = fitness_function(individual.chromosome);
-        }
-        
-        // Replace population
-        replacePopulation(offspring);
-        
-        // Update statistics
-        double total_fitness = 0.0;
-        for (const auto& ind : population) {
-            total_fitness += ind.fitness;
-        }
-        double avg_fitness = total_fitness / population.size();
-        
-        best_fitness_history.push_back(best_fitness);
-        avg_fitness_history.push_back(avg_fitness);
+    // Replace population
+    replacePopulation();
+    refineElites();
+    
+    recordGeneration(fitness_sum / config.population_size);
+}
+
+void GeneticAlgorithm::refineElites() {
+    int count = std::min(config.local_search_elites, config.population_size);
+    if (count <= 0 || !local_search) {
+        return;
+    }
+    PROFILE_TRACE("ga.local_search");
+    
+    std::pmr::vector<int>& order = population_order;
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin() + count, order.end(),
+        [this](int a, int b) { return fitness[a] > fitness[b]; });
+    
+    refine_genes.resize(static_cast<size_t>(count) * chromosome_length);
+    refine_scores.resize(count);
+    refine_phenotypes.resize(static_cast<size_t>(count) * phenotype_words);
+    
+    const double limit = mutation_operator->getParams().gene_limit;
+    for (int k = 0; k < count; k++) {
+        const double* src = chromosomeAt(genes, order[k]);
+        eval_buffer.assign(src, src + chromosome_length);
+        local_search(eval_buffer);
         
-        // Print progress
-        if (config.verbose) {
-            if (gen % 10 == 0 || gen == config.max_generations - 1) {
-                printGenerationStats(gen);
-            }
+        double* dst = chromosomeAt(refine_genes, k);
+        for (int i = 0; i < chromosome_length; i++) {
+            dst[i] = std::min(limit, std::max(-limit, eval_buffer[i]));
         }
     }
     
-    if (config.verbose) {
-        std::cout << "\n=== Evolution Complete ===\n";
-        printStatistics();
+    evaluateBatch(refine_genes.data(), count, refine_scores.data(),
+                  phenotype_words > 0 ? refine_phenotypes.data() : nullptr);
+    evaluations += count;
+    
+    // A refinement that beats best_fitness also beats its original, so it
+    // is written back below
+    updateBest(refine_genes.data(), scoreStats(refine_scores.data(), count));
+    
+    // Write refined genes back unless the refinement lost fitness
+    bool changed = false;
+    for (int k = 0; k < count; k++) {
+        if (refine_scores[k] >= fitness[order[k]]) {
+            copyChromosome(refine_genes, k, genes, order[k]);
+            if (phenotype_words > 0) copyPhenotype(refine_phenotypes, k, phenotypes, order[k]);
+            fitness[order[k]] = refine_scores[k];
+            changed = true;
+        }
+    }
+    if (changed) {
+        fitness_sum = std::accumulate(fitness.begin(), fitness.end(), 0.0);
+        accumulateGenotype();
     }
 }
 
-void GeneticAlgorithm::printGenerationStats(int generation) const {
-    double avg_fitness = avg_fitness_history.back();
-    
-    std::cout << "Gen " << std::setw(4) << generation 
-              << " | Best: " << std::fixed << std::setprecision(4) << best_fitness
-              << " | Avg: " << avg_fitness << "\n";
+double GeneticAlgorithm::diversity() const {
+    // Mean per-gene standard deviation across the population
+    const int n = chromosome_length;
+    const int pop = config.population_size;
+    double total = 0.0;
+    for (int i = 0; i < n; i++) {
+        double mean = gene_sum[i] / pop;
+        double var = std::max(0.0, gene_sum_sq[i] / pop - mean * mean);
+        total += std::sqrt(var);
+    }
+    return total / n;
 }
 
-void GeneticAlgorithm::printStatistics() const {
-    std::cout << "\nFinal Statistics:\n";
-    std::cout << "  Best Fitness: " << std::fixed << std::setprecision(4) 
-              << best_fitness << "\n";
-    std::cout << "  Generations: " << best_fitness_history.size() << "\n";
+GenotypeDiversity GeneticAlgorithm::genotypeDiversity() const {
+    // The mean squared distance over distinct pairs is 2 pop / (pop - 1)
+    // times the total variance around the centroid
+    const int n = chromosome_length;
+    const int pop = config.population_size;
+    double total = 0.0;
+    for (int i = 0; i < n; i++) {
+        double mean = gene_sum[i] / pop;
+        total += std::max(0.0, gene_sum_sq[i] / pop - mean * mean);
+    }
+    GenotypeDiversity spread;
+    spread.gene_variance = total / n;
+    if (pop > 1) {
+        spread.pairwise_distance = std::sqrt(2.0 * pop / (pop - 1) * total);
+    }
+    return spread;
 }
 
-std::function<double(const std::vector<double>&)> createMLPFitnessFunction(
-    MLP& mlp,
-    const std::vector<std::vector<double>>& X_train,
-    const std::vector<int>& y_train
-) {
-    return [&mlp, &X_train, &y_train](const std::vector<double>& chromosome) {
-        mlp.setWeights(chromosome);
-        return mlp.evaluateAccuracy(X_train, y_train);
-    };
-}
\ No newline at end of file
+double GeneticAlgorithm::phenotypeDiversity() const {
+    return predictionDisagreement(phenotypes.data(), config.population_size);
+}
+
+std::vector<std::vector<double>> GeneticAlgorithm::getElites(int count) const {
+    std::vector<int> order(config.population_size);
+    std::iota(order.begin(), order.end(), 0);
+    count = std::min(count, config.population_size);
+    std::partial_sort(order.begin(), order.begin() + count, order.end(),
+                      [this](int a, int b) { return fitness[a] > fitness[b]; });
+    
+    std::vector<std::vector<double>> elites;
+    for (int i = 0; i < count; i++) {
+        const double* g = genes.data() + static_cast<size_t>(order[i]) * chromosome_length;
+        elites.emplace_back(g, g + chromosome_length);
+    }
+    return elites;
+}
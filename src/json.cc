@@ -0,0 +1,281 @@
+#include "json.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+class JsonParser {
+private:
+    const std::string& text;
+    size_t pos;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        int line = 1 + static_cast<int>(std::count(text.begin(), text.begin() + pos, '\n'));
+        throw std::runtime_error("JSON parse error at line " + std::to_string(line) + ": " + message);
+    }
+
+    void skipWhitespace() {
+        while (pos < text.size()) {
+            char c = text[pos];
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                pos++;
+            } else {
+                break;
+            }
+        }
+    }
+
+    bool consume(const char* literal) {
+        size_t len = std::char_traits<char>::length(literal);
+        if (text.compare(pos, len, literal) == 0) {
+            pos += len;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        skipWhitespace();
+        if (pos >= text.size() || text[pos] != c) {
+            fail(std::string("expected '") + c + "'");
+        }
+        pos++;
+    }
+
+    static void appendUtf8(std::string& out, unsigned int code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    std::string parseString() {
+        expect('"');
+        std::string out;
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) fail("unterminated escape");
+            char e = text[pos++];
+            switch (e) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    if (pos + 4 > text.size()) fail("short \\u escape");
+                    unsigned int code = std::stoul(text.substr(pos, 4), nullptr, 16);
+                    pos += 4;
+                    appendUtf8(out, code);
+                    break;
+                }
+                default: fail(std::string("bad escape '\\") + e + "'");
+            }
+        }
+        if (pos >= text.size()) fail("unterminated string");
+        pos++;
+        return out;
+    }
+
+    JsonValue parseNumber() {
+        const char* begin = text.c_str() + pos;
+        char* end = nullptr;
+        double value = std::strtod(begin, &end);
+        if (end == begin) fail("invalid value");
+        pos += end - begin;
+
+        JsonValue v;
+        v.type = JsonValue::Type::NUMBER;
+        v.number_value = value;
+        return v;
+    }
+
+public:
+    explicit JsonParser(const std::string& input) : text(input), pos(0) {}
+
+    JsonValue parseValue() {
+        skipWhitespace();
+        if (pos >= text.size()) fail("unexpected end of input");
+
+        JsonValue v;
+        char c = text[pos];
+        if (c == '{') {
+            pos++;
+            v.type = JsonValue::Type::OBJECT;
+            skipWhitespace();
+            if (pos < text.size() && text[pos] == '}') {
+                pos++;
+                return v;
+            }
+            for (;;) {
+                skipWhitespace();
+                std::string key = parseString();
+                expect(':');
+                v.object_items.emplace_back(key, parseValue());
+                skipWhitespace();
+                if (pos < text.size() && text[pos] == ',') {
+                    pos++;
+                    continue;
+                }
+                expect('}');
+                return v;
+            }
+        }
+        if (c == '[') {
+            pos++;
+            v.type = JsonValue::Type::ARRAY;
+            skipWhitespace();
+            if (pos < text.size() && text[pos] == ']') {
+                pos++;
+                return v;
+            }
+            for (;;) {
+                v.array_items.push_back(parseValue());
+                skipWhitespace();
+                if (pos < text.size() && text[pos] == ',') {
+                    pos++;
+                    continue;
+                }
+                expect(']');
+                return v;
+            }
+        }
+        if (c == '"') {
+            v.type = JsonValue::Type::STRING;
+            v.string_value = parseString();
+            return v;
+        }
+        if (consume("true")) {
+            v.type = JsonValue::Type::BOOL;
+            v.bool_value = true;
+            return v;
+        }
+        if (consume("false")) {
+            v.type = JsonValue::Type::BOOL;
+            return v;
+        }
+        if (consume("null")) {
+            return v;
+        }
+        return parseNumber();
+    }
+
+    JsonValue parseDocument() {
+        JsonValue v = parseValue();
+        skipWhitespace();
+        if (pos != text.size()) fail("trailing characters");
+        return v;
+    }
+};
+
+JsonValue JsonValue::parse(const std::string& text) {
+    return JsonParser(text).parseDocument();
+}
+
+JsonValue JsonValue::parseFile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open " + filename);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    try {
+        return parse(buffer.str());
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(filename + ": " + e.what());
+    }
+}
+
+bool JsonValue::asBool() const {
+    if (type != Type::BOOL) throw std::runtime_error("JSON value is not a boolean");
+    return bool_value;
+}
+
+double JsonValue::asNumber() const {
+    if (type != Type::NUMBER) throw std::runtime_error("JSON value is not a number");
+    return number_value;
+}
+
+int JsonValue::asInt() const {
+    double v = asNumber();
+    if (v != std::floor(v)) throw std::runtime_error("JSON number is not an integer");
+    return static_cast<int>(v);
+}
+
+long JsonValue::asLong() const {
+    double v = asNumber();
+    if (v != std::floor(v)) throw std::runtime_error("JSON number is not an integer");
+    return static_cast<long>(v);
+}
+
+const std::string& JsonValue::asString() const {
+    if (type != Type::STRING) throw std::runtime_error("JSON value is not a string");
+    return string_value;
+}
+
+const std::vector<JsonValue>& JsonValue::asArray() const {
+    if (type != Type::ARRAY) throw std::runtime_error("JSON value is not an array");
+    return array_items;
+}
+
+const std::vector<std::pair<std::string, JsonValue>>& JsonValue::asObject() const {
+    if (type != Type::OBJECT) throw std::runtime_error("JSON value is not an object");
+    return object_items;
+}
+
+bool JsonValue::has(const std::string& key) const {
+    for (const auto& item : asObject()) {
+        if (item.first == key) return true;
+    }
+    return false;
+}
+
+const JsonValue& JsonValue::operator[](const std::string& key) const {
+    for (const auto& item : asObject()) {
+        if (item.first == key) return item.second;
+    }
+    throw std::runtime_error("Missing JSON key: " + key);
+}
+
+double JsonValue::getNumber(const std::string& key, double fallback) const {
+    return has(key) ? (*this)[key].asNumber() : fallback;
+}
+
+int JsonValue::getInt(const std::string& key, int fallback) const {
+    return has(key) ? (*this)[key].asInt() : fallback;
+}
+
+long JsonValue::getLong(const std::string& key, long fallback) const {
+    return has(key) ? (*this)[key].asLong() : fallback;
+}
+
+bool JsonValue::getBool(const std::string& key, bool fallback) const {
+    return has(key) ? (*this)[key].asBool() : fallback;
+}
+
+std::string JsonValue::getString(const std::string& key, const std::string& fallback) const {
+    return has(key) ? (*this)[key].asString() : fallback;
+}
+
+void JsonValue::checkKeys(const std::vector<std::string>& allowed, const std::string& context) const {
+    for (const auto& item : asObject()) {
+        if (std::find(allowed.begin(), allowed.end(), item.first) == allowed.end()) {
+            throw std::runtime_error("Unknown key '" + item.first + "' in " + context);
+        }
+    }
+}
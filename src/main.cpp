@@ -3,69 +3,19 @@
 #include <string>
 #include <chrono>
 #include <iomanip>
+#include <cstdlib>
 #include "dataset.h"
 #include "mlp.h"
 #include "ga.h"
+#include "cmaes.h"
 #include "utils.h"
 #include "results.h"
-
-void runExperiment(Dataset& dataset, 
-                   const std::vector<int>& architecture,
-                   ResultsManager& results_manager,
-                   const GAConfig& ga_config,
-                   int run_id,
-                   unsigned int seed) {
-    
-    ExperimentResult exp_result;
-    exp_result.network_structure = architecture;
-    exp_result.run_id = run_id;
-    exp_result.seed = seed;
-    
-    for (int fold = 0; fold < 10; fold++) {
-        std::vector<std::vector<double>> train_X, test_X;
-        std::vector<int> train_y, test_y;
-        dataset.getTrainTestSplit(fold, train_X, train_y, test_X, test_y);
-
-        MLP mlp(architecture, ActivationType::SIGMOID);
-
-        GeneticAlgorithm ga(mlp.getChromosomeLength(), ga_config);
-
-        auto fitness_func = createMLPFitnessFunction(mlp, train_X, train_y);
-        ga.setFitnessFunction(fitness_func);
-        ga.evolve();
-
-        mlp.setWeights(ga.getBestIndividual().chromosome);
-        
-        double train_acc = mlp.evaluateAccuracy(train_X, train_y);
-        double test_acc = mlp.evaluateAccuracy(test_X, test_y);
-
-        std::vector<int> train_pred, test_pred;
-        for (const auto& x : train_X) {
-            train_pred.push_back(mlp.predict(x));
-        }
-        for (const auto& x : test_X) {
-            test_pred.push_back(mlp.predict(x));
-        }
-        
-        auto train_metrics = Utils::calculateMetrics(train_pred, train_y);
-        auto test_metrics = Utils::calculateMetrics(test_pred, test_y);
-
-        FoldResult fold_result;
-        fold_result.fold_number = fold + 1;
-        fold_result.train_accuracy = train_acc;
-        fold_result.test_accuracy = test_acc;
-        fold_result.train_metrics = train_metrics;
-        fold_result.test_metrics = test_metrics;
-        fold_result.generations_used = ga_config.max_generations;
-        fold_result.best_fitness = ga.getBestFitness();
-        
-        exp_result.fold_results.push_back(fold_result);
-    }
-
-    exp_result.calculate();
-    
-    results_manager.addExperiment(exp_result);
-}
+#include "thread_pool.h"
+#include "arena.h"
+#include "profiler.h"
+#include "metrics.h"
+#include "sweep.h"
+#include "search.h"
 
 int main(int argc, char* argv[]) {
     std::cout << "======================================\n";
@@ -76,112 +26,172 @@ int main(int argc, char* argv[]) {
 
     Utils::initRandom(42);
 
-    Dataset dataset;
-    std::string filename = "data/wdbc.data";
-    
-    if (argc > 1) {
-        filename = argv[1];
+    // mlp_ga_wdbc [--spec sweep.json] [--shard i/N] [dataset]
+    std::string spec_file;
+    std::string dataset_override;
+    ShardSpec shard;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--spec" && i + 1 < argc) {
+            spec_file = argv[++i];
+        } else if (arg == "--shard" && i + 1 < argc) {
+            try {
+                shard = ShardSpec::parse(argv[++i]);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << "\n";
+                return 1;
+            }
+        } else {
+            dataset_override = arg;
+        }
     }
-    
-    if (!dataset.loadFromFile(filename)) {
+
+    SweepSpec spec;
+    try {
+        if (!spec_file.empty()) {
+            spec = SweepSpec::fromFile(spec_file);
+            std::cout << "Sweep spec: " << spec_file << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid sweep spec: " << e.what() << "\n";
+        return 1;
+    }
+    if (!dataset_override.empty()) {
+        spec.dataset_path = dataset_override;
+    }
+
+    Dataset dataset;
+    if (!dataset.loadFromFile(spec.dataset_path)) {
         std::cerr << "Failed to load dataset\n";
         return 1;
     }
     
     dataset.printStatistics();
     
-    dataset.normalize();
+    // Fold normalization z-scores each training fold lazily instead
+    if (!spec.fold_normalization) {
+        dataset.normalize();
+    }
+    if (!spec.features.empty()) {
+        dataset.applyPipeline(spec.features);
+        std::cout << "Feature pipeline: " << spec.features.describe() << " -> "
+                  << dataset.getInputWidth() << " inputs (cached)\n";
+    }
 
-    GAConfig ga_config;
-    ga_config.population_size = 50;
-    ga_config.max_generations = 100;
-    ga_config.crossover_rate = 0.8;
-    ga_config.mutation_rate = 0.15;
-    ga_config.mutation_strength = 0.3;
-    ga_config.elitism_rate = 0.1;
-    ga_config.tournament_size = 3;
-    ga_config.verbose = false; 
-    
-    std::cout << "\nGA Configuration:\n";
-    std::cout << "  Population size: " << ga_config.population_size << "\n";
-    std::cout << "  Max generations: " << ga_config.max_generations << "\n";
-    std::cout << "  Crossover rate: " << ga_config.crossover_rate << "\n";
-    std::cout << "  Mutation rate: " << ga_config.mutation_rate << "\n";
-    std::cout << "  Elitism rate: " << ga_config.elitism_rate << "\n\n";
+    try {
+        spec.validate(dataset);
+        if (shard.enabled() && spec.search.mode != SearchMode::GRID) {
+            throw std::invalid_argument("--shard needs the grid search mode (rungs rank all "
+                                        "candidates together)");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid sweep spec: " << e.what() << "\n";
+        return 1;
+    }
+    
+    spec.print();
     
     ResultsManager results_manager;
     
-    const int NUM_RUNS = 100;
-
-    std::vector<std::vector<int>> architectures = {
-        // 1 hidden layer (neurons: 5-50)
-        {30, 5, 1}, {30, 8, 1}, {30, 10, 1}, {30, 12, 1}, {30, 15, 1},
-        {30, 18, 1}, {30, 20, 1}, {30, 25, 1}, {30, 30, 1}, {30, 40, 1}, {30, 50, 1},
-        
-        // 2 hidden layers
-        {30, 20, 10, 1}, {30, 25, 15, 1}, {30, 30, 15, 1}, {30, 20, 5, 1},
-        {30, 15, 10, 1}, {30, 15, 5, 1}, {30, 10, 5, 1}, {30, 25, 10, 1},
-        {30, 30, 20, 1}, {30, 40, 20, 1}, {30, 25, 5, 1},
-        
-        // 3 hidden layers
-        {30, 20, 15, 10, 1}, {30, 25, 20, 10, 1}, {30, 30, 20, 10, 1},
-        {30, 20, 10, 5, 1}, {30, 15, 10, 5, 1}, {30, 25, 15, 5, 1},
-        {30, 30, 15, 5, 1}, {30, 40, 20, 10, 1},
-        
-        // 4 hidden layers
-        {30, 30, 20, 10, 5, 1}, {30, 25, 20, 15, 10, 1},
-        {30, 20, 15, 10, 5, 1}, {30, 40, 30, 20, 10, 1}
-    };
+    // Hardware counters are opt-in: each reading costs a syscall
+    const char* perf_env = std::getenv("MLP_GA_PERF_COUNTERS");
+    if (Profiler::enabled && perf_env && std::string(perf_env) == "1") {
+        Profiler::enableHardwareCounters(true);
+        std::cout << "Hardware counters: "
+                  << (PerfCounters::supported() ? "enabled" : "unavailable (perf_event_open failed)")
+                  << "\n";
+    }
     
-    int total_experiments = NUM_RUNS * architectures.size();
-    int current_exp = 0;
+    // Fold jobs run on the pool, each worker with its own arena
+    const int num_threads = spec.threads > 0 ? spec.threads : ThreadPool::defaultThreadCount();
+    std::unique_ptr<ThreadPool> pool_owner;
+    if (spec.numa) {
+        // Pinned workers, per-node queues and a node-local copy of the inputs
+        NumaTopology topology = NumaTopology::detect();
+        pool_owner.reset(new ThreadPool(num_threads, topology));
+        dataset.replicateInputs(topology);
+        std::cout << "NUMA: " << topology.describe() << ", workers pinned, inputs on "
+                  << dataset.numReplicas() << (dataset.numReplicas() == 1 ? " node\n" : " nodes\n");
+    } else {
+        pool_owner.reset(new ThreadPool(num_threads));
+    }
+    ThreadPool& pool = *pool_owner;
+    ArenaPool arenas(pool.size());
+    std::cout << "Worker threads: " << pool.size() << "\n";
     
-    std::cout << "\nTotal Experiments: " << total_experiments << "\n";
-    std::cout << "Expected Output Lines: " << (total_experiments * 10) << "\n\n";
+    // A search expands its rungs as it goes; the grid is planned up front
+    const bool grid = spec.search.mode == SearchMode::GRID;
+    SweepPlan plan;
+    int plan_experiments = 0;    // full plan size, written into shard files
+    if (grid) {
+        plan = SweepPlan::expand(spec, dataset);
+        if (shard.enabled()) {
+            plan_experiments = static_cast<int>(plan.experiments.size());
+            std::cout << "\nShard " << shard.index << "/" << shard.count << " of "
+                      << plan.experiments.size() << " experiments";
+            plan = plan.shard(shard);
+        }
+        int total_experiments = static_cast<int>(plan.experiments.size());
+        
+        std::cout << "\nTotal Experiments: " << total_experiments << "\n";
+        std::cout << "Expected Output Lines: " << (total_experiments * spec.num_folds) << "\n\n";
+        SweepMetrics::global().experiments_total = total_experiments;
+    }
+    
+    // Optional live metrics for the job runner (Prometheus and/or JSON file)
+    MetricsExporter exporter(pool);
+    const char* metrics_port = std::getenv("MLP_GA_METRICS_PORT");
+    const char* metrics_file = std::getenv("MLP_GA_METRICS_FILE");
+    const char* metrics_interval = std::getenv("MLP_GA_METRICS_INTERVAL");
+    if (metrics_port || metrics_file) {
+        int port = metrics_port ? std::atoi(metrics_port) : 0;
+        double interval = metrics_interval ? std::atof(metrics_interval) : 5.0;
+        if (exporter.start(port, metrics_file ? metrics_file : "", interval)) {
+            if (port > 0) {
+                std::cout << "Metrics: http://127.0.0.1:" << port << "/metrics\n";
+            }
+            if (metrics_file) {
+                std::cout << "Metrics file: " << metrics_file << "\n";
+            }
+        } else {
+            std::cerr << "Could not bind metrics port " << port << "\n";
+        }
+    }
     
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    for (int run = 0; run < NUM_RUNS; run++) {
-        std::cout << "\n" << std::string(80, '=') << "\n";
-        std::cout << "RUN " << (run + 1) << "/" << NUM_RUNS << "\n";
-        std::cout << std::string(80, '=') << "\n";
-        
-        unsigned int seed = 42 + run * 1000;
-        Utils::initRandom(seed);
-
-        dataset.createKFolds(10, seed);
-
-        for (const auto& arch : architectures) {
-            current_exp++;
-            
-            auto current_time = std::chrono::high_resolution_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                current_time - start_time).count();
-            
-            double avg_time_per_exp = (current_exp > 0) ? 
-                (double)elapsed / current_exp : 0;
-            int remaining = total_experiments - current_exp;
-            int eta_seconds = (int)(avg_time_per_exp * remaining);
-            
-            std::cout << "\rProgress: " << current_exp << "/" << total_experiments 
-                      << " (" << std::fixed << std::setprecision(1)
-                      << (100.0 * current_exp / total_experiments) << "%)";
-            std::cout << " | Elapsed: " << (elapsed / 60) << "m " << (elapsed % 60) << "s";
-            std::cout << " | ETA: " << (eta_seconds / 60) << "m " 
-                      << (eta_seconds % 60) << "s" << std::flush;
-            
-            runExperiment(dataset, arch, results_manager, ga_config, 
-                         run + 1, seed);
+    SweepRunner runner(spec, dataset, pool, arenas);
+    EliteBank elite_bank;
+    const std::string& bank_file = spec.warm_start.bank_file;
+    if (spec.warm_start.enabled && !bank_file.empty()) {
+        try {
+            if (elite_bank.load(bank_file)) {
+                std::cout << "Elite bank: " << elite_bank.size() << " entries from "
+                          << bank_file << "\n";
+            }
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
         }
-        
-        std::cout << "\n";
-        
-        if ((run + 1) % 10 == 0) {
-            std::string checkpoint_file = "checkpoint_run_" + 
-                                         std::to_string(run + 1) + ".csv";
-            results_manager.saveAllResults(checkpoint_file);
-            std::cout << "Checkpoint saved: " << checkpoint_file << "\n";
+        runner.setEliteBank(&elite_bank);
+    }
+    ArchitectureSearch search(spec, dataset, runner);
+    try {
+        if (grid) {
+            // Shards would overwrite each other's checkpoints
+            runner.run(plan, results_manager, !shard.enabled());
+        } else {
+            search.run(results_manager);
+        }
+    } catch (const std::exception& e) {
+        // A fold job threw: keep the experiments that did finish
+        std::cerr << "\nSweep failed: " << e.what() << "\n";
+        if (results_manager.size() > 0) {
+            const std::string partial_file = shard.enabled()
+                ? shard.fileName("all_results_partial.csv") : "all_results_partial.csv";
+            results_manager.saveAllResults(partial_file);
         }
+        return 1;
     }
     
     auto end_time = std::chrono::high_resolution_clock::now();
@@ -191,22 +201,61 @@ int main(int argc, char* argv[]) {
     std::cout << "\n\nTotal training time: " << total_duration << " minutes\n";
     
     results_manager.printComparison();
+    results_manager.printWarmStartSavings();
+    if (!grid) {
+        search.printReport();
+    }
     
     std::cout << "\n" << std::string(80, '=') << "\n";
     std::cout << "Saving final results to CSV files...\n";
     std::cout << std::string(80, '=') << "\n";
     
-    results_manager.saveAllResults("all_results_final.csv");
-    results_manager.saveSummaryResults("results_summary_final.csv");
+    // Shard files carry the plan size and positions for merge_shards
+    const std::string all_results_file = shard.enabled()
+        ? shard.fileName("all_results_final.csv") : "all_results_final.csv";
+    const std::string summary_file = shard.enabled()
+        ? shard.fileName("results_summary_final.csv") : "results_summary_final.csv";
+    results_manager.saveAllResults(all_results_file, plan_experiments);
+    results_manager.saveSummaryResults(summary_file, plan_experiments);
+    if (!grid) {
+        search.saveLog("search_log.csv");
+    }
+    if (shard.enabled() && spec.warm_start.enabled && !bank_file.empty()) {
+        std::cout << "Elite bank not saved: shards would overwrite each other's\n";
+    } else if (spec.warm_start.enabled && !bank_file.empty()) {
+        try {
+            elite_bank.save(bank_file);
+            std::cout << "Elite bank saved to " << bank_file << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+        }
+    }
     
     std::cout << "\n" << std::string(80, '=') << "\n";
     std::cout << "All experiments completed!\n";
     std::cout << "Total Experiments: " << results_manager.size() << "\n";
-    std::cout << "Total Output Lines: " << (results_manager.size() * 10) << "\n";
+    std::cout << "Total Output Lines: " << (results_manager.size() * spec.num_folds) << "\n";
     std::cout << "Output files:\n";
-    std::cout << "  - all_results_final.csv      (detailed per-fold results)\n";
-    std::cout << "  - results_summary_final.csv  (summary statistics)\n";
-    std::cout << "  - checkpoint_run_*.csv       (intermediate checkpoints)\n";
+    if (shard.enabled()) {
+        std::cout << "  - " << all_results_file << "\n";
+        std::cout << "  - " << summary_file << "\n";
+        std::cout << "  (merge all " << shard.count << " shards with: merge_shards "
+                  << shard.count << ")\n";
+    } else {
+        std::cout << "  - all_results_final.csv      (detailed per-fold results)\n";
+        std::cout << "  - results_summary_final.csv  (summary statistics)\n";
+    }
+    if (!grid) {
+        std::cout << "  - search_log.csv             (per-rung scores and promotions)\n";
+    } else if (spec.checkpoint_every > 0 && !shard.enabled()) {
+        std::cout << "  - checkpoint_run_*.csv       (intermediate checkpoints)\n";
+    }
+    if (Profiler::enabled) {
+        Profiler::writeJSON("profile.json");
+        Profiler::writeChromeTrace("profile_trace.json");
+        std::cout << "  - profile.json               (per-phase timings)\n";
+        std::cout << "  - profile_trace.json         (Chrome trace events)\n";
+    }
     std::cout << std::string(80, '=') << "\n";
     
     return 0;
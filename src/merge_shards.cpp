@@ -0,0 +1,35 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "shard.h"
+
+// merge_shards N [directory]
+//
+// Combines the per-shard CSVs of a sweep run as "mlp_ga_wdbc --shard i/N"
+// (i = 1..N, sharing a filesystem) into all_results_final.csv and
+// results_summary_final.csv, byte-identical to a single-process run.
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: merge_shards N [directory]\n";
+        return 1;
+    }
+    int count = std::atoi(argv[1]);
+    if (count < 1) {
+        std::cerr << "shard count must be positive, got \"" << argv[1] << "\"\n";
+        return 1;
+    }
+    std::string directory = argc == 3 ? argv[2] : "";
+
+    const char* files[] = {"all_results_final.csv", "results_summary_final.csv"};
+    try {
+        for (const char* base : files) {
+            std::string output = (directory.empty() ? "" : directory + "/") + base;
+            mergeShardFiles(directory, base, count, output);
+            std::cout << "Merged " << count << " shards into " << output << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "merge_shards: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
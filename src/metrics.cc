@@ -0,0 +1,317 @@
+#include "metrics.h"
+#include "thread_pool.h"
+#include <chrono>
+#include <algorithm>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+namespace {
+    int64_t clockNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+SweepMetrics::SweepMetrics()
+    : experiments_total(0), experiments_completed(0), folds_completed(0),
+      evaluations(0), generations(0), last_progress_ns(clockNanoseconds()) {}
+
+void SweepMetrics::recordProgress(long evaluation_count, long generation_count) {
+    evaluations.fetch_add(evaluation_count, std::memory_order_relaxed);
+    generations.fetch_add(generation_count, std::memory_order_relaxed);
+    last_progress_ns.store(clockNanoseconds(), std::memory_order_relaxed);
+}
+
+SweepMetrics& SweepMetrics::global() {
+    static SweepMetrics metrics;
+    return metrics;
+}
+
+MetricsExporter::MetricsExporter(const ThreadPool& thread_pool)
+    : pool(thread_pool), port(0), interval_seconds(5.0), listen_fd(-1),
+      stopping(false), start_ns(clockNanoseconds()),
+      evaluations_per_second(0.0), generations_per_second(0.0),
+      utilization(thread_pool.size(), 0.0) {
+    previous.time_ns = start_ns;
+    previous.evaluations = 0;
+    previous.generations = 0;
+    previous.busy_ns.assign(pool.size(), 0);
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::openSocket() {
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    // Local only: the job runner scrapes from the same host
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listen_fd, 8) < 0) {
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+bool MetricsExporter::start(int http_port, const std::string& json_file, double interval) {
+    port = http_port;
+    json_path = json_file;
+    interval_seconds = interval > 0 ? interval : 5.0;
+
+    if (port > 0 && !openSocket()) {
+        return false;
+    }
+    if (port <= 0 && json_path.empty()) {
+        return true;
+    }
+
+    stopping = false;
+    thread = std::thread(&MetricsExporter::run, this);
+    return true;
+}
+
+void MetricsExporter::stop() {
+    stopping = true;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+}
+
+void MetricsExporter::run() {
+    const int64_t interval_ns = static_cast<int64_t>(interval_seconds * 1e9);
+    int64_t next_sample = clockNanoseconds() + interval_ns;
+
+    while (!stopping) {
+        // Wake at least every 200 ms so stop() is prompt
+        int64_t wait_ns = std::min<int64_t>(next_sample - clockNanoseconds(), 200000000);
+        int timeout_ms = static_cast<int>(std::max<int64_t>(0, wait_ns / 1000000));
+
+        if (listen_fd >= 0) {
+            pollfd pfd;
+            pfd.fd = listen_fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLIN)) {
+                int client = accept(listen_fd, nullptr, nullptr);
+                if (client >= 0) {
+                    serveClient(client);
+                    close(client);
+                }
+            }
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+        }
+
+        if (clockNanoseconds() >= next_sample) {
+            sample();
+            next_sample += interval_ns;
+
+            if (!json_path.empty()) {
+                // Write then rename so readers never see a partial file
+                std::string tmp = json_path + ".tmp";
+                std::ofstream file(tmp);
+                file << jsonText();
+                file.close();
+                std::rename(tmp.c_str(), json_path.c_str());
+            }
+        }
+    }
+}
+
+void MetricsExporter::sample() {
+    SweepMetrics& m = SweepMetrics::global();
+    Snapshot now;
+    now.time_ns = clockNanoseconds();
+    now.evaluations = m.evaluations.load(std::memory_order_relaxed);
+    now.generations = m.generations.load(std::memory_order_relaxed);
+    now.busy_ns.resize(pool.size());
+    for (int w = 0; w < pool.size(); w++) {
+        now.busy_ns[w] = pool.busyNanoseconds(w);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    double dt = (now.time_ns - previous.time_ns) / 1e9;
+    if (dt > 0) {
+        evaluations_per_second = (now.evaluations - previous.evaluations) / dt;
+        generations_per_second = (now.generations - previous.generations) / dt;
+        for (int w = 0; w < pool.size(); w++) {
+            utilization[w] = std::min(1.0, (now.busy_ns[w] - previous.busy_ns[w]) / 1e9 / dt);
+        }
+    }
+    previous = now;
+}
+
+void MetricsExporter::serveClient(int client_fd) {
+    // Only the request line matters; bound the wait for it
+    pollfd pfd;
+    pfd.fd = client_fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, 1000) <= 0) {
+        return;
+    }
+
+    char buffer[2048];
+    ssize_t n = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
+    if (n <= 0) {
+        return;
+    }
+    buffer[n] = '\0';
+
+    std::string request(buffer);
+    std::string path;
+    if (request.compare(0, 4, "GET ") == 0) {
+        size_t end = request.find(' ', 4);
+        path = request.substr(4, end == std::string::npos ? std::string::npos : end - 4);
+    }
+
+    std::string status = "200 OK";
+    std::string content_type;
+    std::string body;
+    if (path == "/metrics") {
+        content_type = "text/plain; version=0.0.4";
+        body = prometheusText();
+    } else if (path == "/metrics.json") {
+        content_type = "application/json";
+        body = jsonText();
+    } else {
+        status = "404 Not Found";
+        content_type = "text/plain";
+        body = "not found\n";
+    }
+
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n"
+             << "Content-Type: " << content_type << "\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    std::string text = response.str();
+
+    size_t sent = 0;
+    while (sent < text.size()) {
+        ssize_t k = send(client_fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (k <= 0) {
+            break;
+        }
+        sent += k;
+    }
+}
+
+std::string MetricsExporter::prometheusText() {
+    SweepMetrics& m = SweepMetrics::global();
+    int64_t now = clockNanoseconds();
+    std::ostringstream out;
+
+    auto metric = [&out](const char* name, const char* type, const char* help) {
+        out << "# HELP " << name << " " << help << "\n"
+            << "# TYPE " << name << " " << type << "\n";
+    };
+
+    metric("mlp_ga_experiments_total", "gauge", "Experiments in the sweep");
+    out << "mlp_ga_experiments_total " << m.experiments_total.load() << "\n";
+    metric("mlp_ga_experiments_completed_total", "counter", "Experiments finished");
+    out << "mlp_ga_experiments_completed_total " << m.experiments_completed.load() << "\n";
+    metric("mlp_ga_folds_completed_total", "counter", "Fold jobs finished");
+    out << "mlp_ga_folds_completed_total " << m.folds_completed.load() << "\n";
+    metric("mlp_ga_evaluations_total", "counter", "Fitness evaluations");
+    out << "mlp_ga_evaluations_total " << m.evaluations.load() << "\n";
+    metric("mlp_ga_generations_total", "counter", "Optimizer generations");
+    out << "mlp_ga_generations_total " << m.generations.load() << "\n";
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        metric("mlp_ga_evaluations_per_second", "gauge", "Evaluation rate over the last interval");
+        out << "mlp_ga_evaluations_per_second " << evaluations_per_second << "\n";
+        metric("mlp_ga_generations_per_second", "gauge", "Generation rate over the last interval");
+        out << "mlp_ga_generations_per_second " << generations_per_second << "\n";
+        metric("mlp_ga_worker_utilization", "gauge", "Fraction of the last interval spent in tasks");
+        for (size_t w = 0; w < utilization.size(); w++) {
+            out << "mlp_ga_worker_utilization{worker=\"" << w << "\"} " << utilization[w] << "\n";
+        }
+    }
+
+    metric("mlp_ga_worker_busy_seconds_total", "counter", "Time spent running tasks");
+    for (int w = 0; w < pool.size(); w++) {
+        out << "mlp_ga_worker_busy_seconds_total{worker=\"" << w << "\"} "
+            << pool.busyNanoseconds(w) / 1e9 << "\n";
+    }
+    metric("mlp_ga_queue_depth", "gauge", "Tasks waiting for a worker");
+    out << "mlp_ga_queue_depth " << pool.queueDepth() << "\n";
+    metric("mlp_ga_resident_bytes", "gauge", "Resident set size");
+    out << "mlp_ga_resident_bytes " << residentBytes() << "\n";
+    metric("mlp_ga_seconds_since_progress", "gauge", "Time since any optimizer finished a generation");
+    out << "mlp_ga_seconds_since_progress "
+        << (now - m.last_progress_ns.load()) / 1e9 << "\n";
+    metric("mlp_ga_uptime_seconds", "gauge", "Time since the exporter was created");
+    out << "mlp_ga_uptime_seconds " << (now - start_ns) / 1e9 << "\n";
+
+    return out.str();
+}
+
+std::string MetricsExporter::jsonText() {
+    SweepMetrics& m = SweepMetrics::global();
+    int64_t now = clockNanoseconds();
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+
+    out << "{\n"
+        << "  \"experiments_total\": " << m.experiments_total.load() << ",\n"
+        << "  \"experiments_completed\": " << m.experiments_completed.load() << ",\n"
+        << "  \"folds_completed\": " << m.folds_completed.load() << ",\n"
+        << "  \"evaluations\": " << m.evaluations.load() << ",\n"
+        << "  \"generations\": " << m.generations.load() << ",\n";
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        out << "  \"evaluations_per_second\": " << evaluations_per_second << ",\n"
+            << "  \"generations_per_second\": " << generations_per_second << ",\n"
+            << "  \"worker_utilization\": [";
+        for (size_t w = 0; w < utilization.size(); w++) {
+            out << (w > 0 ? ", " : "") << utilization[w];
+        }
+        out << "],\n";
+    }
+
+    out << "  \"queue_depth\": " << pool.queueDepth() << ",\n"
+        << "  \"resident_bytes\": " << residentBytes() << ",\n"
+        << "  \"seconds_since_progress\": " << (now - m.last_progress_ns.load()) / 1e9 << ",\n"
+        << "  \"uptime_seconds\": " << (now - start_ns) / 1e9 << "\n"
+        << "}\n";
+    return out.str();
+}
+
+long MetricsExporter::residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    long size = 0, resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+}
@@ -1,39 +1,61 @@
 #include "mlp.h"
+#include "profiler.h"
+#include "feature_pipeline.h"
+#include <algorithm>
 
-MLP::MLP(const std::vector<int>& layers, ActivationType act_type) 
-    : layer_sizes(layers), activation_type(act_type), total_params(0) {
+MLP::MLP(const std::vector<int>& layers, ActivationType act_type,
+         std::pmr::memory_resource* resource)
+    : layer_sizes(layers), activation_type(act_type), total_params(0), params(resource),
+      input_normalization(nullptr) {
     
     if (layers.size() < 2) {
         throw std::invalid_argument("Network must have at least input and output layers");
     }
     
-    // Calculate total number of parameters
+    // Lay out weights and biases in chromosome order
     for (size_t i = 0; i < layers.size() - 1; i++) {
+        weight_offsets.push_back(total_params);
         total_params += layers[i] * layers[i + 1];  // weights
+        bias_offsets.push_back(total_params);
         total_params += layers[i + 1];  // biases
     }
     
-    // Initialize weight and bias structures
-    weights.resize(layers.size() - 1);
-    biases.resize(layers.size() - 1);
-    layer_outputs.resize(layers.size());
+    params.resize(total_params, 0.0);
+}
+
+MLP::~MLP() {}
+
+MLPContext::MLPContext(const MLP& mlp) : logits(nullptr) {
+    reserve(mlp);
+}
+
+void MLPContext::reserve(const MLP& mlp) {
+    const std::vector<int>& layers = mlp.getLayerSizes();
+    if (shape == layers) {
+        return;
+    }
     
-    for (size_t i = 0; i < layers.size() - 1; i++) {
-        weights[i].resize(layers[i]);
-        for (int j = 0; j < layers[i]; j++) {
-            weights[i][j].resize(layers[i + 1], 0.0);
-        }
-        biases[i].resize(layers[i + 1], 0.0);
+    size_t total = 0;
+    for (int width : layers) {
+        total += 2 * static_cast<size_t>(block_size) * width;
     }
+    total += static_cast<size_t>(block_size) * layers.back();
     
-    // Initialize layer outputs
+    arena.assign(total, 0.0);
+    activations.resize(layers.size());
+    deltas.resize(layers.size());
+    
+    double* cursor = arena.data();
     for (size_t i = 0; i < layers.size(); i++) {
-        layer_outputs[i].resize(layers[i], 0.0);
+        activations[i] = cursor;
+        cursor += static_cast<size_t>(block_size) * layers[i];
+        deltas[i] = cursor;
+        cursor += static_cast<size_t>(block_size) * layers[i];
     }
+    logits = cursor;
+    shape = layers;
 }
 
-MLP::~MLP() {}
-
 double MLP::sigmoid(double x) const {
     return 1.0 / (1.0 + std::exp(-x));
 }
@@ -46,6 +68,19 @@ double MLP::relu(double x) const {
     return std::max(0.0, x);
 }
 
+double MLP::activateDerivative(double activated) const {
+    switch (activation_type) {
+        case ActivationType::SIGMOID:
+            return activated * (1.0 - activated);
+        case ActivationType::TANH:
+            return 1.0 - activated * activated;
+        case ActivationType::RELU:
+            return activated > 0.0 ? 1.0 : 0.0;
+        default:
+            return activated * (1.0 - activated);
+    }
+}
+
 double MLP::activate(double x) const {
     switch (activation_type) {
         case ActivationType::SIGMOID:
@@ -64,37 +99,14 @@ void MLP::randomInitialize(double min_val, double max_val) {
     std::mt19937 gen(rd());
     std::uniform_real_distribution<> dis(min_val, max_val);
     
-    for (size_t i = 0; i < weights.size(); i++) {
-        for (size_t j = 0; j < weights[i].size(); j++) {
-            for (size_t k = 0; k < weights[i][j].size(); k++) {
-                weights[i][j][k] = dis(gen);
-            }
-        }
-        for (size_t j = 0; j < biases[i].size(); j++) {
-            biases[i][j] = dis(gen);
-        }
+    for (auto& p : params) {
+        p = dis(gen);
     }
 }
 
 std::vector<double> MLP::encodeChromosome() const {
-    std::vector<double> chromosome;
-    chromosome.reserve(total_params);
-    
-    // Encode all weights and biases into a flat vector
-    for (size_t i = 0; i < weights.size(); i++) {
-        // Encode weights
-        for (size_t j = 0; j < weights[i].size(); j++) {
-            for (size_t k = 0; k < weights[i][j].size(); k++) {
-                chromosome.push_back(weights[i][j][k]);
-            }
-        }
-        // Encode biases
-        for (size_t j = 0; j < biases[i].size(); j++) {
-            chromosome.push_back(biases[i][j]);
-        }
-    }
-    
-    return chromosome;
+    // The parameters are already stored in chromosome order
+    return std::vector<double>(params.begin(), params.end());
 }
 
 void MLP::decodeChromosome(const std::vector<double>& chromosome) {
@@ -102,68 +114,129 @@ void MLP::decodeChromosome(const std::vector<double>& chromosome) {
         throw std::invalid_argument("Chromosome size mismatch");
     }
     
-    int idx = 0;
-    
-    // Decode weights and biases from flat vector
-    for (size_t i = 0; i < weights.size(); i++) {
-        // Decode weights
-        for (size_t j = 0; j < weights[i].size(); j++) {
-            for (size_t k = 0; k < weights[i][j].size(); k++) {
-                weights[i][j][k] = chromosome[idx++];
-            }
-        }
-        // Decode biases
-        for (size_t j = 0; j < biases[i].size(); j++) {
-            biases[i][j] = chromosome[idx++];
-        }
+    std::copy(chromosome.begin(), chromosome.end(), params.begin());
+}
+
+long long MLP::forwardFlops() const {
+    long long flops = 0;
+    for (size_t layer = 0; layer + 1 < layer_sizes.size(); layer++) {
+        flops += (2LL * layer_sizes[layer] + 1) * layer_sizes[layer + 1];
     }
+    return flops;
 }
 
 void MLP::setWeights(const std::vector<double>& chromosome) {
+    PROFILE_SCOPE("mlp.set_weights");
     decodeChromosome(chromosome);
 }
 
-std::vector<double> MLP::forward(const std::vector<double>& input) {
-    if (input.size() != static_cast<size_t>(layer_sizes[0])) {
-        throw std::invalid_argument("Input size mismatch");
+void MLP::setInputNormalization(const InputNormalization* norm) {
+    if (norm && !norm->empty() && static_cast<int>(norm->mean.size()) != layer_sizes[0]) {
+        throw std::invalid_argument("Input normalization width mismatch");
+    }
+    input_normalization = norm && !norm->empty() ? norm : nullptr;
+}
+
+const double* MLP::foldInputs(const double* p, std::vector<double>& folded) const {
+    if (!input_normalization) {
+        return p;
     }
+    const int n_in = layer_sizes[0];
+    const int n_out = layer_sizes[1];
+    const std::vector<double>& mean = input_normalization->mean;
+    const std::vector<double>& inv_std = input_normalization->inv_std;
+    folded.assign(p, p + total_params);
     
-    // Set input layer
-    layer_outputs[0] = input;
+    // W (x - m) / s + b = (W / s) x + (b - sum_i W_i m_i / s_i)
+    double* W = folded.data() + weight_offsets[0];
+    double* b = folded.data() + bias_offsets[0];
+    for (int i = 0; i < n_in; i++) {
+        double* w = W + static_cast<size_t>(i) * n_out;
+        const double shift = mean[i] * inv_std[i];
+        for (int j = 0; j < n_out; j++) {
+            b[j] -= w[j] * shift;
+            w[j] *= inv_std[i];
+        }
+    }
+    return folded.data();
+}
+
+void MLP::forwardBlock(const double* p, const SampleView& samples, int begin, int count,
+                       MLPContext& ctx, int first_layer) const {
+    const size_t num_layers = layer_sizes.size() - 1;
     
-    // Forward propagation through each layer
-    for (size_t layer = 0; layer < weights.size(); layer++) {
-        for (size_t j = 0; j < layer_outputs[layer + 1].size(); j++) {
-            double sum = biases[layer][j];
+    for (size_t layer = first_layer; layer < num_layers; layer++) {
+        const int n_in = layer_sizes[layer];
+        const int n_out = layer_sizes[layer + 1];
+        const double* W = p + weight_offsets[layer];
+        const double* b = p + bias_offsets[layer];
+        const bool output_layer = layer == num_layers - 1;
+        
+        for (int r = 0; r < count; r++) {
+            // The input layer is read straight from the sample rows
+            const double* x = layer == 0 ? samples.row(begin + r)
+                                         : ctx.activations[layer] + static_cast<size_t>(r) * n_in;
+            double* z = ctx.activations[layer + 1] + static_cast<size_t>(r) * n_out;
             
-            for (size_t i = 0; i < layer_outputs[layer].size(); i++) {
-                sum += layer_outputs[layer][i] * weights[layer][i][j];
+            std::copy(b, b + n_out, z);
+            for (int i = 0; i < n_in; i++) {
+                const double xi = x[i];
+                const double* w = W + static_cast<size_t>(i) * n_out;
+                for (int j = 0; j < n_out; j++) {
+                    z[j] += xi * w[j];
+                }
             }
             
-            // Apply activation function
-            // Use sigmoid for output layer (binary classification)
-            if (layer == weights.size() - 1) {
-                layer_outputs[layer + 1][j] = sigmoid(sum);
+            // Use sigmoid for output layer (binary classification),
+            // keeping the logits for the margin-based fitness kernels
+            if (output_layer) {
+                double* logit = ctx.logits + static_cast<size_t>(r) * n_out;
+                for (int j = 0; j < n_out; j++) {
+                    logit[j] = z[j];
+                    z[j] = sigmoid(z[j]);
+                }
             } else {
-                layer_outputs[layer + 1][j] = activate(sum);
+                for (int j = 0; j < n_out; j++) {
+                    z[j] = activate(z[j]);
+                }
             }
         }
     }
-    
-    return layer_outputs.back();
 }
 
-int MLP::predict(const std::vector<double>& input) {
-    std::vector<double> output = forward(input);
+std::vector<double> MLP::forward(const std::vector<double>& input, MLPContext& ctx) const {
+    if (input.size() != static_cast<size_t>(layer_sizes[0])) {
+        throw std::invalid_argument("Input size mismatch");
+    }
     
+    ctx.reserve(*this);
+    
+    SampleView view;
+    view.data = input.data();
+    view.stride = layer_sizes[0];
+    view.count = 1;
+    forwardBlock(foldInputs(params.data(), ctx.folded), view, 0, 1, ctx);
+    
+    const double* out = ctx.activations.back();
+    return std::vector<double>(out, out + layer_sizes.back());
+}
+
+std::vector<double> MLP::forward(const std::vector<double>& input) const {
+    MLPContext ctx(*this);
+    return forward(input, ctx);
+}
+
+namespace {
+
+int classFromOutput(const double* output, int size) {
     // For binary classification with single output neuron
-    if (output.size() == 1) {
+    if (size == 1) {
         return output[0] >= 0.5 ? 1 : 0;
     }
     
     // For multi-output (softmax-like)
     int max_idx = 0;
-    for (size_t i = 1; i < output.size(); i++) {
+    for (int i = 1; i < size; i++) {
         if (output[i] > output[max_idx]) {
             max_idx = i;
         }
@@ -171,21 +244,329 @@ int MLP::predict(const std::vector<double>& input) {
     return max_idx;
 }
 
+} // namespace
+
+int MLP::predict(const std::vector<double>& input, MLPContext& ctx) const {
+    std::vector<double> output = forward(input, ctx);
+    return classFromOutput(output.data(), static_cast<int>(output.size()));
+}
+
+int MLP::predict(const std::vector<double>& input) const {
+    MLPContext ctx(*this);
+    return predict(input, ctx);
+}
+
 double MLP::evaluateAccuracy(const std::vector<std::vector<double>>& X,
-                             const std::vector<int>& y) {
+                             const std::vector<int>& y) const {
     if (X.size() != y.size()) {
         throw std::invalid_argument("X and y size mismatch");
     }
     
-    int correct = 0;
-    for (size_t i = 0; i < X.size(); i++) {
-        int pred = predict(X[i]);
-        if (pred == y[i]) {
-            correct++;
+    FeatureMatrix matrix = FeatureMatrix::fromRows(X);
+    return evaluateAccuracy(SampleView(matrix, y));
+}
+
+double MLP::evaluateAccuracy(const SampleView& samples) const {
+    return evaluate(samples, FitnessType::ACCURACY).accuracy();
+}
+
+double MLP::evaluateFitness(const double* p, const SampleView& samples,
+                            FitnessType type, MLPContext& ctx) const {
+    return evaluate(p, samples, type, ctx).fitness(type);
+}
+
+Utils::ClassificationMetrics MLP::evaluateMetrics(const SampleView& samples) const {
+    return evaluate(samples, FitnessType::ACCURACY).metrics();
+}
+
+EvaluationStats MLP::evaluate(const SampleView& samples, FitnessType type) const {
+    MLPContext ctx(*this);
+    return evaluate(params.data(), samples, type, ctx);
+}
+
+EvaluationStats MLP::evaluate(const double* p, const SampleView& samples,
+                              FitnessType type, MLPContext& ctx,
+                              uint64_t* predictions) const {
+    PROFILE_SCOPE("mlp.forward");
+    PROFILE_PERF("mlp.forward");
+    PROFILE_COUNT("mlp.samples", samples.count);
+    PROFILE_COUNT("mlp.forward.flops", samples.count * forwardFlops());
+    ctx.reserve(*this);
+    p = foldInputs(p, ctx.folded);
+    
+    EvaluationStats stats;
+    stats.count = samples.count;
+    
+    for (int begin = 0; begin < samples.count; begin += MLPContext::block_size) {
+        int count = std::min(MLPContext::block_size, samples.count - begin);
+        forwardBlock(p, samples, begin, count, ctx);
+        accumulateBlock(samples, begin, count, type, ctx, stats, predictions);
+    }
+    
+    return stats;
+}
+
+void MLP::finishBlock(const double* p, const SampleView& samples, int begin, int count,
+                      FitnessType type, MLPContext& ctx, EvaluationStats& stats,
+                      uint64_t* predictions) const {
+    const int width = layer_sizes[1];
+    double* z = ctx.activations[1];
+    for (int k = 0; k < count * width; k++) {
+        z[k] = activate(z[k]);
+    }
+    forwardBlock(p, samples, begin, count, ctx, 1);
+    accumulateBlock(samples, begin, count, type, ctx, stats, predictions);
+}
+
+void MLP::accumulateBlock(const SampleView& samples, int begin, int count,
+                          FitnessType type, const MLPContext& ctx,
+                          EvaluationStats& stats, uint64_t* predictions) const {
+    const int n_out = layer_sizes.back();
+    const double eps = 1e-12;
+    const double* out = ctx.activations.back();
+    const double* z = ctx.logits;
+    for (int r = 0; r < count; r++) {
+        const double* a = out + static_cast<size_t>(r) * n_out;
+        const double* zr = z + static_cast<size_t>(r) * n_out;
+        int label = samples.label(begin + r);
+        int pred = classFromOutput(a, n_out);
+        
+        if (predictions) {
+            const int row = begin + r;
+            const uint64_t bit = uint64_t(1) << (row & 63);
+            if (pred == 1) {
+                predictions[row >> 6] |= bit;
+            } else {
+                predictions[row >> 6] &= ~bit;
+            }
+        }
+        
+        if (pred == label) {
+            stats.correct++;
+        }
+        if (pred == 1 && label == 1) {
+            stats.true_positive++;
+        } else if (pred == 0 && label == 0) {
+            stats.true_negative++;
+        } else if (pred == 1 && label == 0) {
+            stats.false_positive++;
+        } else if (pred == 0 && label == 1) {
+            stats.false_negative++;
+        }
+        
+        if (type == FitnessType::ACCURACY) {
+            continue;
+        }
+        
+        // Signed margin of the true class on the logit scale
+        double margin;
+        if (n_out == 1) {
+            margin = label == 1 ? zr[0] : -zr[0];
+        } else {
+            double other = -1e300;
+            for (int j = 0; j < n_out; j++) {
+                if (j != label) other = std::max(other, zr[j]);
+            }
+            margin = zr[label] - other;
+        }
+        
+        switch (type) {
+            case FitnessType::LOG_LOSS:
+                for (int j = 0; j < n_out; j++) {
+                    double target = n_out == 1 ? label : (label == j ? 1.0 : 0.0);
+                    stats.log_loss_sum -= target * std::log(a[j] + eps) +
+                                          (1.0 - target) * std::log(1.0 - a[j] + eps);
+                }
+                break;
+            case FitnessType::HINGE_MARGIN:
+                stats.hinge_sum += std::max(0.0, 1.0 - margin);
+                break;
+            case FitnessType::ACCURACY_MARGIN:
+                stats.margin_sum += std::tanh(margin);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+double EvaluationStats::fitness(FitnessType type) const {
+    if (count == 0) return 0.0;
+    
+    const double n = count;
+    switch (type) {
+        case FitnessType::LOG_LOSS:
+            return std::exp(-log_loss_sum / n);
+        case FitnessType::HINGE_MARGIN:
+            return 1.0 / (1.0 + hinge_sum / n);
+        case FitnessType::ACCURACY_MARGIN:
+            // Tie-break stays below one accuracy step (1/n)
+            return accuracy() + (0.5 / n) * (0.5 + 0.5 * margin_sum / n);
+        default:
+            return accuracy();
+    }
+}
+
+Utils::ClassificationMetrics EvaluationStats::metrics() const {
+    Utils::ClassificationMetrics m = {true_positive, true_negative,
+                                      false_positive, false_negative,
+                                      0.0, 0.0, 0.0, 0.0};
+    m.calculate();
+    return m;
+}
+
+double MLP::computeGradient(const double* p, const SampleView& samples, double* grad,
+                            MLPContext& ctx) const {
+    ctx.reserve(*this);
+    const double* raw = p;
+    p = foldInputs(p, ctx.folded);
+    
+    const int num_layers = static_cast<int>(layer_sizes.size()) - 1;
+    const int n_final = layer_sizes.back();
+    const double eps = 1e-12;
+    
+    std::fill(grad, grad + total_params, 0.0);
+    double loss = 0.0;
+    
+    for (int begin = 0; begin < samples.count; begin += MLPContext::block_size) {
+        int count = std::min(MLPContext::block_size, samples.count - begin);
+        forwardBlock(p, samples, begin, count, ctx);
+        
+        // Output delta for sigmoid + binary cross-entropy: a - t
+        const double* out = ctx.activations.back();
+        double* delta_out = ctx.deltas.back();
+        for (int r = 0; r < count; r++) {
+            int label = samples.label(begin + r);
+            for (int j = 0; j < n_final; j++) {
+                double target = n_final == 1 ? label : (label == j ? 1.0 : 0.0);
+                double a = out[r * n_final + j];
+                delta_out[r * n_final + j] = a - target;
+                loss -= target * std::log(a + eps) + (1.0 - target) * std::log(1.0 - a + eps);
+            }
         }
+        
+        // Backward through the layers
+        for (int layer = num_layers - 1; layer >= 0; layer--) {
+            const int n_in = layer_sizes[layer];
+            const int n_out = layer_sizes[layer + 1];
+            const double* W = p + weight_offsets[layer];
+            double* gW = grad + weight_offsets[layer];
+            double* gb = grad + bias_offsets[layer];
+            const double* D = ctx.deltas[layer + 1];
+            
+            for (int r = 0; r < count; r++) {
+                const double* d = D + static_cast<size_t>(r) * n_out;
+                const double* x = layer == 0 ? samples.row(begin + r)
+                                             : ctx.activations[layer] + static_cast<size_t>(r) * n_in;
+                for (int i = 0; i < n_in; i++) {
+                    const double xi = x[i];
+                    double* gw = gW + static_cast<size_t>(i) * n_out;
+                    for (int j = 0; j < n_out; j++) {
+                        gw[j] += xi * d[j];
+                    }
+                }
+                for (int j = 0; j < n_out; j++) {
+                    gb[j] += d[j];
+                }
+            }
+            
+            if (layer == 0) break;
+            
+            // Propagate delta to the previous hidden layer
+            double* D_prev = ctx.deltas[layer];
+            const double* A_prev = ctx.activations[layer];
+            for (int r = 0; r < count; r++) {
+                const double* d = D + static_cast<size_t>(r) * n_out;
+                for (int i = 0; i < n_in; i++) {
+                    const double* w = W + static_cast<size_t>(i) * n_out;
+                    double sum = 0.0;
+                    for (int j = 0; j < n_out; j++) {
+                        sum += w[j] * d[j];
+                    }
+                    size_t idx = static_cast<size_t>(r) * n_in + i;
+                    D_prev[idx] = sum * activateDerivative(A_prev[idx]);
+                }
+            }
+        }
+    }
+    
+    const double scale = 1.0 / samples.count;
+    for (int k = 0; k < total_params; k++) {
+        grad[k] *= scale;
     }
     
-    return static_cast<double>(correct) / X.size();
+    // Back to normalized-input space: dW = (dW' - m db') / s, db = db'
+    if (p != raw) {
+        const int n_in = layer_sizes[0];
+        const int n_out = layer_sizes[1];
+        double* gW = grad + weight_offsets[0];
+        const double* gb = grad + bias_offsets[0];
+        for (int i = 0; i < n_in; i++) {
+            double* gw = gW + static_cast<size_t>(i) * n_out;
+            const double m = input_normalization->mean[i];
+            const double inv_s = input_normalization->inv_std[i];
+            for (int j = 0; j < n_out; j++) {
+                gw[j] = (gw[j] - m * gb[j]) * inv_s;
+            }
+        }
+    }
+    return loss * scale;
+}
+
+void MLP::gradientDescent(std::vector<double>& chromosome, const SampleView& samples,
+                          int steps, double learning_rate, MLPContext& ctx) const {
+    if (chromosome.size() != static_cast<size_t>(total_params)) {
+        throw std::invalid_argument("Chromosome size mismatch");
+    }
+    
+    std::vector<double> grad(total_params);
+    for (int step = 0; step < steps; step++) {
+        computeGradient(chromosome.data(), samples, grad.data(), ctx);
+        for (int k = 0; k < total_params; k++) {
+            chromosome[k] -= learning_rate * grad[k];
+        }
+    }
+}
+
+ActivationType parseActivationType(const std::string& name) {
+    if (name == "sigmoid") return ActivationType::SIGMOID;
+    if (name == "tanh") return ActivationType::TANH;
+    if (name == "relu") return ActivationType::RELU;
+    throw std::invalid_argument("Unknown activation type: " + name);
+}
+
+std::string activationTypeName(ActivationType type) {
+    switch (type) {
+        case ActivationType::SIGMOID:
+            return "sigmoid";
+        case ActivationType::TANH:
+            return "tanh";
+        case ActivationType::RELU:
+            return "relu";
+    }
+    return "sigmoid";
+}
+
+FitnessType parseFitnessType(const std::string& name) {
+    if (name == "accuracy") return FitnessType::ACCURACY;
+    if (name == "log_loss") return FitnessType::LOG_LOSS;
+    if (name == "hinge_margin") return FitnessType::HINGE_MARGIN;
+    if (name == "accuracy_margin") return FitnessType::ACCURACY_MARGIN;
+    throw std::invalid_argument("Unknown fitness type: " + name);
+}
+
+std::string fitnessTypeName(FitnessType type) {
+    switch (type) {
+        case FitnessType::ACCURACY:
+            return "accuracy";
+        case FitnessType::LOG_LOSS:
+            return "log_loss";
+        case FitnessType::HINGE_MARGIN:
+            return "hinge_margin";
+        case FitnessType::ACCURACY_MARGIN:
+            return "accuracy_margin";
+    }
+    return "accuracy";
 }
 
 void MLP::printStructure() const {
@@ -0,0 +1,124 @@
+#include "mutation.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Additive noise drawn per gene, applied where the rate mask fires
+class NoiseMutation : public MutationOperator {
+public:
+    explicit NoiseMutation(const MutationParams& p) : MutationOperator(p) {}
+    
+    void apply(double* genes, double*, int num_individuals, int length,
+               Utils::FastRandom& rng) override {
+        const int total = num_individuals * length;
+        if (static_cast<int>(draws.size()) < total) {
+            draws.resize(total);
+            noise.resize(total);
+        }
+        
+        rng.fillUniform(draws.data(), total, 0.0, 1.0);
+        switch (params.type) {
+            case MutationType::UNIFORM:
+                rng.fillUniform(noise.data(), total, -params.strength, params.strength);
+                break;
+            case MutationType::CAUCHY:
+                rng.fillCauchy(noise.data(), total, params.strength);
+                break;
+            default:
+                rng.fillGaussian(noise.data(), total, 0.0, params.strength);
+                break;
+        }
+        
+        const double rate = params.rate;
+        const double limit = params.gene_limit;
+        const double* d = draws.data();
+        const double* z = noise.data();
+        for (int i = 0; i < total; i++) {
+            double mutated = genes[i] + (d[i] < rate ? z[i] : 0.0);
+            genes[i] = std::min(limit, std::max(-limit, mutated));
+        }
+    }
+};
+
+// Log-normal self-adaptation: sigma' = sigma * exp(tau' N + tau N_i),
+// then x_i += sigma'_i N'_i for the genes selected by the rate mask
+class SelfAdaptiveMutation : public MutationOperator {
+private:
+    std::vector<double> selection;
+    
+public:
+    explicit SelfAdaptiveMutation(const MutationParams& p) : MutationOperator(p) {}
+    
+    bool usesStepSizes() const override { return true; }
+    
+    void apply(double* genes, double* step_sizes, int num_individuals, int length,
+               Utils::FastRandom& rng) override {
+        const int total = num_individuals * length;
+        if (static_cast<int>(draws.size()) < total) {
+            draws.resize(total);
+            noise.resize(total);
+            selection.resize(total);
+        }
+        
+        const double tau_global = 1.0 / std::sqrt(2.0 * length);
+        const double tau_local = 1.0 / std::sqrt(2.0 * std::sqrt(static_cast<double>(length)));
+        
+        rng.fillGaussian(draws.data(), total, 0.0, tau_local);
+        rng.fillGaussian(noise.data(), total, 0.0, 1.0);
+        rng.fillUniform(selection.data(), total, 0.0, 1.0);
+        
+        const double rate = params.rate;
+        const double min_step = params.min_step;
+        const double limit = params.gene_limit;
+        for (int ind = 0; ind < num_individuals; ind++) {
+            double common = tau_global * rng.nextGaussian();
+            double* x = genes + static_cast<size_t>(ind) * length;
+            double* sigma = step_sizes + static_cast<size_t>(ind) * length;
+            const double* d = draws.data() + static_cast<size_t>(ind) * length;
+            const double* z = noise.data() + static_cast<size_t>(ind) * length;
+            const double* u = selection.data() + static_cast<size_t>(ind) * length;
+            
+            for (int i = 0; i < length; i++) {
+                bool selected = u[i] < rate;
+                double adapted = std::max(min_step, sigma[i] * std::exp(common + d[i]));
+                double s = selected ? adapted : sigma[i];
+                sigma[i] = s;
+                double mutated = x[i] + (selected ? s * z[i] : 0.0);
+                x[i] = std::min(limit, std::max(-limit, mutated));
+            }
+        }
+    }
+};
+
+} // namespace
+
+std::unique_ptr<MutationOperator> createMutationOperator(const MutationParams& params) {
+    if (params.type == MutationType::SELF_ADAPTIVE) {
+        return std::unique_ptr<MutationOperator>(new SelfAdaptiveMutation(params));
+    }
+    return std::unique_ptr<MutationOperator>(new NoiseMutation(params));
+}
+
+MutationType parseMutationType(const std::string& name) {
+    if (name == "uniform") return MutationType::UNIFORM;
+    if (name == "gaussian") return MutationType::GAUSSIAN;
+    if (name == "cauchy") return MutationType::CAUCHY;
+    if (name == "self_adaptive") return MutationType::SELF_ADAPTIVE;
+    throw std::invalid_argument("Unknown mutation type: " + name);
+}
+
+std::string mutationTypeName(MutationType type) {
+    switch (type) {
+        case MutationType::UNIFORM:
+            return "uniform";
+        case MutationType::GAUSSIAN:
+            return "gaussian";
+        case MutationType::CAUCHY:
+            return "cauchy";
+        case MutationType::SELF_ADAPTIVE:
+            return "self_adaptive";
+    }
+    return "gaussian";
+}
@@ -0,0 +1,108 @@
+#include "numa.h"
+#include <fstream>
+#include <sstream>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// "0-3,8-11" -> {0, 1, 2, 3, 8, 9, 10, 11}
+std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return std::vector<int>();
+        }
+    }
+    return cpus;
+}
+
+} // namespace
+
+NumaTopology NumaTopology::detect() {
+    NumaTopology topology;
+#ifdef __linux__
+    // Node ids can be sparse (e.g. "0,2"), so take them from the online list
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string ids;
+    if (online.is_open()) {
+        std::getline(online, ids);
+    }
+    for (int node : parseCpuList(ids)) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file.is_open()) continue;
+        std::string line;
+        std::getline(file, line);
+        std::vector<int> cpus = parseCpuList(line);
+        if (!cpus.empty()) {
+            topology.node_cpus.push_back(cpus);
+        }
+    }
+#endif
+    if (topology.node_cpus.empty()) {
+        unsigned int n = std::thread::hardware_concurrency();
+        topology.node_cpus.emplace_back();
+        for (unsigned int cpu = 0; cpu < (n > 0 ? n : 1); cpu++) {
+            topology.node_cpus[0].push_back(static_cast<int>(cpu));
+        }
+    }
+    return topology;
+}
+
+int NumaTopology::cpuForWorker(int worker) const {
+    const std::vector<int>& cpus = node_cpus[nodeForWorker(worker)];
+    return cpus[(worker / numNodes()) % cpus.size()];
+}
+
+int NumaTopology::nodeForWorker(int worker) const {
+    return worker % numNodes();
+}
+
+std::string NumaTopology::describe() const {
+    std::string text = std::to_string(numNodes()) + (numNodes() == 1 ? " node (" : " nodes (");
+    for (int node = 0; node < numNodes(); node++) {
+        if (node > 0) text += ", ";
+        text += std::to_string(node_cpus[node].size()) + " CPUs";
+    }
+    return text + ")";
+}
+
+bool pinCurrentThread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+bool pinCurrentThreadToNode(const NumaTopology& topology, int node) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : topology.node_cpus[node]) {
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)topology;
+    (void)node;
+    return false;
+#endif
+}
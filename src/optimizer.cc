@@ -0,0 +1,431 @@
+#include "optimizer.h"
+#include "ga.h"
+#include "cmaes.h"
+#include "profiler.h"
+#include "metrics.h"
+#include "packed_mlp.h"
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+Optimizer::Optimizer(int chrom_length, bool verbose_output,
+                     std::pmr::memory_resource* resource)
+    : chromosome_length(chrom_length), verbose(verbose_output),
+      generation(0), evaluations(0), stop_reason(StopReason::NONE),
+      best_fitness(0.0),
+      phenotype_samples(0), phenotype_words(0), batch_predictions(resource),
+      sample_positives(resource), restarts(0), restart_generation(0),
+      seed_random_fraction(0.0), seed_perturbation(0.0),
+      eval_buffer(chrom_length), batch_scores(resource), stats_scores(nullptr) {
+}
+
+void Optimizer::setPhenotypeSamples(int samples) {
+    phenotype_samples = std::max(samples, 0);
+    phenotype_words = ::predictionWords(phenotype_samples);
+}
+
+void Optimizer::setFitnessFunction(FitnessFunction func) {
+    fitness_function = func;
+}
+
+void Optimizer::setSeedChromosomes(const std::vector<std::vector<double>>& seeds,
+                                   double random_fraction, double perturbation) {
+    seed_chromosomes.clear();
+    for (const auto& seed : seeds) {
+        if (static_cast<int>(seed.size()) == chromosome_length) {
+            seed_chromosomes.push_back(seed);
+        }
+    }
+    seed_random_fraction = random_fraction;
+    seed_perturbation = perturbation;
+}
+
+std::vector<std::vector<double>> Optimizer::getElites(int count) const {
+    std::vector<std::vector<double>> elites;
+    if (count > 0 && !best_individual.chromosome.empty()) {
+        elites.push_back(best_individual.chromosome);
+    }
+    return elites;
+}
+
+void Optimizer::evaluateBatch(const double* genes, int count, double* scores,
+                              uint64_t* predictions) {
+    PROFILE_TRACE("optimizer.evaluate");
+    PROFILE_COUNT("optimizer.evaluations", count);
+    
+    batch_stats = BatchStats();
+    if (batch_fitness_function) {
+        batch_fitness_function(genes, count, scores, predictions);
+        for (int i = 0; i < count; i++) {
+            batch_stats.add(i, scores[i]);
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            const double* chrom = genes + static_cast<size_t>(i) * chromosome_length;
+            std::copy(chrom, chrom + chromosome_length, eval_buffer.begin());
+            scores[i] = fitness_function(eval_buffer);
+            batch_stats.add(i, scores[i]);
+        }
+    }
+    stats_scores = scores;
+}
+
+const BatchStats& Optimizer::scoreStats(const double* scores, int count) {
+    if (stats_scores != scores || batch_stats.count != count) {
+        batch_stats = BatchStats();
+        for (int i = 0; i < count; i++) {
+            batch_stats.add(i, scores[i]);
+        }
+    }
+    stats_scores = nullptr;
+    return batch_stats;
+}
+
+double Optimizer::predictionDisagreement(const uint64_t* predictions, int count) const {
+    if (count < 2 || phenotype_samples == 0) {
+        return 0.0;
+    }
+    // A sample predicted positive by c of n individuals splits c (n - c)
+    // of the n (n - 1) / 2 pairs
+    sample_positives.assign(phenotype_samples, 0);
+    for (int i = 0; i < count; i++) {
+        const uint64_t* bits = predictions + static_cast<size_t>(i) * phenotype_words;
+        for (int r = 0; r < phenotype_samples; r++) {
+            sample_positives[r] += static_cast<int>((bits[r >> 6] >> (r & 63)) & 1);
+        }
+    }
+    double split = 0.0;
+    for (int c : sample_positives) {
+        split += static_cast<double>(c) * (count - c);
+    }
+    return 2.0 * split / (static_cast<double>(count) * (count - 1) * phenotype_samples);
+}
+
+void Optimizer::updateBest(const double* genes, const BatchStats& stats) {
+    if (stats.best_index >= 0 && stats.best > best_fitness) {
+        best_fitness = stats.best;
+        const double* chrom = genes + static_cast<size_t>(stats.best_index) * chromosome_length;
+        best_individual.chromosome.assign(chrom, chrom + chromosome_length);
+        best_individual.fitness = best_fitness;
+    }
+}
+
+void Optimizer::initialize() {
+    generation = 0;
+    evaluations = 0;
+    stop_reason = maxGenerations() > 0 ? StopReason::NONE : StopReason::MAX_GENERATIONS;
+    best_fitness = 0.0;
+    best_individual = Individual();
+    stats_scores = nullptr;
+    restarts = 0;
+    restart_generation = 0;
+    best_fitness_history.clear();
+    avg_fitness_history.clear();
+    gene_variance_history.clear();
+    pairwise_distance_history.clear();
+    disagreement_history.clear();
+    initializeState();
+}
+
+void Optimizer::tell(const double* scores, const uint64_t* predictions) {
+    if (phenotype_words > 0 && !predictions) {
+        throw std::invalid_argument("tell() needs the batch's predictions when phenotypes "
+                                    "are tracked");
+    }
+    if (evaluations == 0) {
+        start_time = std::chrono::steady_clock::now();
+    }
+    long evaluations_before = evaluations;
+    int generation_before = generation;
+    evaluations += batchSize();
+    processScores(scores, phenotype_words > 0 ? predictions : nullptr);
+    SweepMetrics::global().recordProgress(evaluations - evaluations_before,
+                                          generation - generation_before);
+}
+
+void Optimizer::recordGeneration(double avg_fitness) {
+    best_fitness_history.push_back(best_fitness);
+    avg_fitness_history.push_back(avg_fitness);
+    GenotypeDiversity spread = genotypeDiversity();
+    gene_variance_history.push_back(spread.gene_variance);
+    pairwise_distance_history.push_back(spread.pairwise_distance);
+    if (phenotype_words > 0) {
+        disagreement_history.push_back(phenotypeDiversity());
+    }
+    
+    // Print progress
+    if (verbose) {
+        if (generation % 10 == 0 || generation == maxGenerations() - 1) {
+            printGenerationStats(generation);
+        }
+    }
+    
+    generation++;
+    checkStopping();
+}
+
+bool Optimizer::checkRestart() {
+    // Needs a generation recorded since the last restart (the GA's
+    // re-evaluation of a restarted population does not count)
+    if (restarts >= restart.max_restarts || generation <= restart_generation) {
+        return false;
+    }
+    bool converged =
+        (restart.min_gene_variance > 0.0 &&
+         gene_variance_history.back() < restart.min_gene_variance) ||
+        (restart.min_disagreement > 0.0 && !disagreement_history.empty() &&
+         disagreement_history.back() < restart.min_disagreement);
+    if (!converged) {
+        return false;
+    }
+    
+    restarts++;
+    restart_generation = generation;
+    if (verbose) {
+        std::cout << "Restart " << restarts << " after generation " << generation << "\n";
+    }
+    restartPopulation();
+    return true;
+}
+
+void Optimizer::checkStopping() {
+    if (generation >= maxGenerations()) {
+        stop_reason = StopReason::MAX_GENERATIONS;
+        return;
+    }
+    
+    if (stopping.target_fitness > 0.0 && best_fitness >= stopping.target_fitness) {
+        stop_reason = StopReason::TARGET_REACHED;
+        return;
+    }
+    
+    if (stopping.max_evaluations > 0 && evaluations >= stopping.max_evaluations) {
+        stop_reason = StopReason::EVALUATION_BUDGET;
+        return;
+    }
+    
+    if (stopping.max_seconds > 0.0) {
+        double elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start_time).count();
+        if (elapsed >= stopping.max_seconds) {
+            stop_reason = StopReason::TIME_BUDGET;
+            return;
+        }
+    }
+    
+    // A converged population is re-seeded instead of stopped
+    if (checkRestart()) {
+        return;
+    }
+    
+    // Stagnation counts from the last restart, so a re-seeded population
+    // gets a full window
+    int window = stopping.stagnation_generations;
+    int since_restart = static_cast<int>(best_fitness_history.size()) - restart_generation;
+    if (window > 0 && since_restart > window) {
+        double gain = best_fitness_history.back() -
+                      best_fitness_history[best_fitness_history.size() - 1 - window];
+        if (gain <= stopping.stagnation_tolerance) {
+            stop_reason = StopReason::STAGNATION;
+            return;
+        }
+    }
+    
+    if (stopping.min_diversity > 0.0 && diversity() < stopping.min_diversity) {
+        stop_reason = StopReason::DIVERSITY_COLLAPSE;
+    }
+}
+
+void Optimizer::evolve() {
+    if (!fitness_function && !batch_fitness_function) {
+        throw std::runtime_error("Fitness function not set");
+    }
+    if (phenotype_words > 0 && !batch_fitness_function) {
+        throw std::runtime_error("Phenotype tracking needs a batch fitness function");
+    }
+    
+    initialize();
+    
+    if (verbose) {
+        std::cout << "\n=== Starting " << name() << " ===\n";
+        std::cout << "Batch size: " << batchSize() << "\n";
+        std::cout << "Max generations: " << maxGenerations() << "\n";
+        std::cout << "Chromosome length: " << chromosome_length << "\n\n";
+    }
+    
+    // Evolution loop
+    while (!isFinished()) {
+        PROFILE_PERF("optimizer.generation");
+        const double* batch = ask();
+        int count = batchSize();
+        batch_scores.resize(count);
+        batch_predictions.resize(static_cast<size_t>(count) * phenotype_words);
+        uint64_t* predictions = phenotype_words > 0 ? batch_predictions.data() : nullptr;
+        evaluateBatch(batch, count, batch_scores.data(), predictions);
+        tell(batch_scores.data(), predictions);
+    }
+    
+    if (verbose) {
+        std::cout << "\n=== Evolution Complete ===\n";
+        printStatistics();
+    }
+}
+
+void Optimizer::printGenerationStats(int generation) const {
+    double avg_fitness = avg_fitness_history.back();
+    
+    std::cout << "Gen " << std::setw(4) << generation 
+              << " | Best: " << std::fixed << std::setprecision(4) << best_fitness
+              << " | Avg: " << avg_fitness
+              << " | Spread: " << pairwise_distance_history.back();
+    if (!disagreement_history.empty()) {
+        std::cout << " | Disagreement: " << disagreement_history.back();
+    }
+    std::cout << "\n";
+}
+
+void Optimizer::printStatistics() const {
+    std::cout << "\nFinal Statistics:\n";
+    std::cout << "  Best Fitness: " << std::fixed << std::setprecision(4) 
+              << best_fitness << "\n";
+    std::cout << "  Generations: " << best_fitness_history.size() << "\n";
+    std::cout << "  Evaluations: " << evaluations << "\n";
+    if (restarts > 0) {
+        std::cout << "  Restarts: " << restarts << "\n";
+    }
+    std::cout << "  Stop reason: " << stopReasonName(stop_reason) << "\n";
+}
+
+std::unique_ptr<Optimizer> createOptimizer(
+    OptimizerType type,
+    int chromosome_length,
+    const GAConfig& ga_config,
+    const CMAESConfig& cmaes_config,
+    std::pmr::memory_resource* resource) {
+    switch (type) {
+        case OptimizerType::SEP_CMAES:
+            return std::unique_ptr<Optimizer>(
+                new SepCMAES(chromosome_length, cmaes_config, resource));
+        case OptimizerType::GA:
+        default:
+            return std::unique_ptr<Optimizer>(
+                new GeneticAlgorithm(chromosome_length, ga_config, resource));
+    }
+}
+
+std::string stopReasonName(StopReason reason) {
+    switch (reason) {
+        case StopReason::NONE:
+            return "none";
+        case StopReason::MAX_GENERATIONS:
+            return "max_generations";
+        case StopReason::STAGNATION:
+            return "stagnation";
+        case StopReason::DIVERSITY_COLLAPSE:
+            return "diversity_collapse";
+        case StopReason::TARGET_REACHED:
+            return "target_reached";
+        case StopReason::EVALUATION_BUDGET:
+            return "evaluation_budget";
+        case StopReason::TIME_BUDGET:
+            return "time_budget";
+    }
+    return "none";
+}
+
+OptimizerType parseOptimizerType(const std::string& name) {
+    if (name == "ga") return OptimizerType::GA;
+    if (name == "sep_cmaes") return OptimizerType::SEP_CMAES;
+    throw std::invalid_argument("Unknown optimizer type: " + name);
+}
+
+std::string optimizerTypeName(OptimizerType type) {
+    switch (type) {
+        case OptimizerType::GA:
+            return "ga";
+        case OptimizerType::SEP_CMAES:
+            return "sep_cmaes";
+    }
+    return "ga";
+}
+
+FitnessFunction createMLPFitnessFunction(
+    const MLP& mlp,
+    const std::vector<std::vector<double>>& X_train,
+    const std::vector<int>& y_train,
+    FitnessType fitness_type
+) {
+    // Flatten once so every evaluation runs the batched kernel
+    auto matrix = std::make_shared<FeatureMatrix>(FeatureMatrix::fromRows(X_train));
+    FitnessFunction on_view = createMLPFitnessFunction(mlp, SampleView(*matrix, y_train),
+                                                       fitness_type);
+    return [matrix, on_view](const std::vector<double>& chromosome) {
+        return on_view(chromosome);
+    };
+}
+
+LocalSearchFunction createMLPLocalSearch(
+    const MLP& mlp,
+    const std::vector<std::vector<double>>& X_train,
+    const std::vector<int>& y_train,
+    int steps,
+    double learning_rate
+) {
+    auto matrix = std::make_shared<FeatureMatrix>(FeatureMatrix::fromRows(X_train));
+    LocalSearchFunction on_view = createMLPLocalSearch(mlp, SampleView(*matrix, y_train),
+                                                       steps, learning_rate);
+    return [matrix, on_view](std::vector<double>& chromosome) {
+        on_view(chromosome);
+    };
+}
+
+FitnessFunction createMLPFitnessFunction(
+    const MLP& mlp,
+    const SampleView& train,
+    FitnessType fitness_type
+) {
+    return [&mlp, train, fitness_type](const std::vector<double>& chromosome) {
+        thread_local MLPContext ctx;
+        return mlp.evaluateFitness(chromosome.data(), train, fitness_type, ctx);
+    };
+}
+
+BatchFitnessFunction createMLPBatchFitnessFunction(
+    const MLP& mlp,
+    const SampleView& train,
+    FitnessType fitness_type
+) {
+    return [&mlp, train, fitness_type](const double* genes, int count, double* scores,
+                                       uint64_t* predictions) {
+        thread_local PackedMLPEvaluator evaluator;
+        thread_local std::vector<PackedMLPEvaluator::Lane> lanes;
+        thread_local std::vector<EvaluationStats> stats;
+        
+        const int length = mlp.getChromosomeLength();
+        const int words = predictionWords(train.count);
+        lanes.clear();
+        for (int i = 0; i < count; i++) {
+            lanes.push_back({&mlp, genes + static_cast<size_t>(i) * length,
+                             predictions ? predictions + static_cast<size_t>(i) * words
+                                         : nullptr});
+        }
+        stats.resize(count);
+        evaluator.evaluate(lanes, train, fitness_type, stats.data());
+        for (int i = 0; i < count; i++) {
+            scores[i] = stats[i].fitness(fitness_type);
+        }
+    };
+}
+
+LocalSearchFunction createMLPLocalSearch(
+    const MLP& mlp,
+    const SampleView& train,
+    int steps,
+    double learning_rate
+) {
+    return [&mlp, train, steps, learning_rate](std::vector<double>& chromosome) {
+        thread_local MLPContext ctx;
+        mlp.gradientDescent(chromosome, train, steps, learning_rate, ctx);
+    };
+}
@@ -0,0 +1,111 @@
+#include "packed_mlp.h"
+#include "profiler.h"
+#include <algorithm>
+
+void PackedMLPEvaluator::evaluate(const std::vector<Lane>& lanes, const SampleView& samples,
+                                  FitnessType type, EvaluationStats* stats) {
+    PROFILE_SCOPE("mlp.packed_forward");
+    PROFILE_PERF("mlp.packed_forward");
+    lane_contexts.resize(lanes.size());
+
+    // Cut the lanes into tiles of at most max_tile_width packed columns
+    int first = 0;
+    int width = 0;
+    for (int i = 0; i < static_cast<int>(lanes.size()); i++) {
+        const MLP& mlp = *lanes[i].mlp;
+        if (i == 0 || lanes[i].mlp != lanes[i - 1].mlp) {
+            MLPContext& ctx = contexts[mlp.getLayerSizes()];
+            ctx.reserve(mlp);
+            lane_contexts[i] = &ctx;
+        } else {
+            lane_contexts[i] = lane_contexts[i - 1];
+        }
+        if (mlp.getNumLayers() < 3) {
+            stats[i] = mlp.evaluate(lanes[i].params, samples, type, *lane_contexts[i],
+                                    lanes[i].predictions);
+            continue;
+        }
+        PROFILE_COUNT("mlp.samples", samples.count);
+        PROFILE_COUNT("mlp.forward.flops", samples.count * mlp.forwardFlops());
+
+        int lane_width = mlp.getLayerSizes()[1];
+        if (width > 0 && width + lane_width > max_tile_width) {
+            evaluateTile(lanes, first, i, samples, type, stats);
+            first = i;
+            width = 0;
+        }
+        width += lane_width;
+    }
+    evaluateTile(lanes, first, static_cast<int>(lanes.size()), samples, type, stats);
+}
+
+void PackedMLPEvaluator::evaluateTile(const std::vector<Lane>& lanes, int first, int last,
+                                      const SampleView& samples, FitnessType type,
+                                      EvaluationStats* stats) {
+    // Gather the first layers: lane weights [input][hidden] become column
+    // blocks of one [input][width] matrix
+    offsets.clear();
+    int width = 0;
+    int n_in = 0;
+    for (int i = first; i < last; i++) {
+        offsets.push_back(width);
+        if (lanes[i].mlp->getNumLayers() >= 3) {
+            width += lanes[i].mlp->getLayerSizes()[1];
+            n_in = lanes[i].mlp->getLayerSizes()[0];
+        }
+    }
+    if (width == 0) return;
+
+    weights.resize(static_cast<size_t>(n_in) * width);
+    biases.resize(width);
+    block.resize(static_cast<size_t>(MLPContext::block_size) * width);
+    for (int i = first; i < last; i++) {
+        const MLP& mlp = *lanes[i].mlp;
+        if (mlp.getNumLayers() < 3) continue;
+        const int h = mlp.getLayerSizes()[1];
+        const int offset = offsets[i - first];
+        const double* params = mlp.foldInputs(lanes[i].params, folded);
+        const double* W = params;                                // layer 0 weights
+        const double* b = params + static_cast<size_t>(n_in) * h;  // layer 0 biases
+        for (int k = 0; k < n_in; k++) {
+            std::copy(W + static_cast<size_t>(k) * h, W + static_cast<size_t>(k + 1) * h,
+                      weights.data() + static_cast<size_t>(k) * width + offset);
+        }
+        std::copy(b, b + h, biases.data() + offset);
+        stats[i] = EvaluationStats();
+        stats[i].count = samples.count;
+    }
+
+    for (int begin = 0; begin < samples.count; begin += MLPContext::block_size) {
+        int count = std::min(MLPContext::block_size, samples.count - begin);
+
+        // One wide kernel for every lane's first layer
+        for (int r = 0; r < count; r++) {
+            const double* x = samples.row(begin + r);
+            double* z = block.data() + static_cast<size_t>(r) * width;
+            std::copy(biases.begin(), biases.end(), z);
+            for (int k = 0; k < n_in; k++) {
+                const double xk = x[k];
+                const double* w = weights.data() + static_cast<size_t>(k) * width;
+                for (int j = 0; j < width; j++) {
+                    z[j] += xk * w[j];
+                }
+            }
+        }
+
+        // Scatter each lane's columns and finish its remaining layers
+        for (int i = first; i < last; i++) {
+            const MLP& mlp = *lanes[i].mlp;
+            if (mlp.getNumLayers() < 3) continue;
+            const int h = mlp.getLayerSizes()[1];
+            const int offset = offsets[i - first];
+            MLPContext& ctx = *lane_contexts[i];
+            for (int r = 0; r < count; r++) {
+                const double* src = block.data() + static_cast<size_t>(r) * width + offset;
+                std::copy(src, src + h, ctx.activations[1] + static_cast<size_t>(r) * h);
+            }
+            mlp.finishBlock(lanes[i].params, samples, begin, count, type, ctx, stats[i],
+                            lanes[i].predictions);
+        }
+    }
+}
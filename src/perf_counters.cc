@@ -0,0 +1,156 @@
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+PerfSample PerfSample::operator-(const PerfSample& other) const {
+    PerfSample d;
+    d.cycles = cycles - other.cycles;
+    d.instructions = instructions - other.instructions;
+    d.cache_references = cache_references - other.cache_references;
+    d.cache_misses = cache_misses - other.cache_misses;
+    d.branch_misses = branch_misses - other.branch_misses;
+    return d;
+}
+
+PerfSample& PerfSample::operator+=(const PerfSample& other) {
+    cycles += other.cycles;
+    instructions += other.instructions;
+    cache_references += other.cache_references;
+    cache_misses += other.cache_misses;
+    branch_misses += other.branch_misses;
+    return *this;
+}
+
+#ifdef __linux__
+
+namespace {
+    const uint64_t event_configs[] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_REFERENCES,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    int openEvent(uint64_t config, int group_fd) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = group_fd == -1 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // Calling thread, any CPU
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+}
+
+PerfCounters::PerfCounters() : available(false) {
+    for (int i = 0; i < num_events; i++) {
+        fds[i] = -1;
+    }
+
+    fds[0] = openEvent(event_configs[0], -1);
+    if (fds[0] < 0) {
+        return;
+    }
+    for (int i = 1; i < num_events; i++) {
+        fds[i] = openEvent(event_configs[i], fds[0]);
+        if (fds[i] < 0) {
+            return;
+        }
+    }
+
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    available = true;
+}
+
+PerfCounters::~PerfCounters() {
+    for (int i = num_events - 1; i >= 0; i--) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+}
+
+PerfSample PerfCounters::read() const {
+    PerfSample sample;
+    if (!available) {
+        return sample;
+    }
+
+    // Layout for PERF_FORMAT_GROUP: nr, time_enabled, time_running, values
+    uint64_t buffer[3 + num_events];
+    if (::read(fds[0], buffer, sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer))) {
+        return sample;
+    }
+
+    double scale = 1.0;
+    if (buffer[2] > 0 && buffer[2] < buffer[1]) {
+        scale = static_cast<double>(buffer[1]) / buffer[2];
+    }
+    const uint64_t* values = buffer + 3;
+    sample.cycles = static_cast<int64_t>(values[0] * scale);
+    sample.instructions = static_cast<int64_t>(values[1] * scale);
+    sample.cache_references = static_cast<int64_t>(values[2] * scale);
+    sample.cache_misses = static_cast<int64_t>(values[3] * scale);
+    sample.branch_misses = static_cast<int64_t>(values[4] * scale);
+    return sample;
+}
+
+bool PerfCounters::supported() {
+    int fd = openEvent(PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (fd < 0) {
+        return false;
+    }
+    close(fd);
+    return true;
+}
+
+#else
+
+PerfCounters::PerfCounters() : available(false) {
+    for (int i = 0; i < num_events; i++) {
+        fds[i] = -1;
+    }
+}
+
+PerfCounters::~PerfCounters() {}
+
+PerfSample PerfCounters::read() const {
+    return PerfSample();
+}
+
+bool PerfCounters::supported() {
+    return false;
+}
+
+#endif
+
+PerfCounters& PerfCounters::forThread() {
+    thread_local PerfCounters counters;
+    return counters;
+}
+
+int PerfCounters::peakFlopsPerCycle() {
+    // Two vector units, each doing one add and one multiply (or one FMA)
+#if defined(__AVX512F__)
+    return 32;
+#elif defined(__AVX2__) && defined(__FMA__)
+    return 16;
+#elif defined(__AVX__)
+    return 8;
+#else
+    return 4;
+#endif
+}
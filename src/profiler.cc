@@ -0,0 +1,376 @@
+#include "profiler.h"
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point epoch = Clock::now();
+
+    // Scope names are string literals, so the pointer identifies them
+    // within a thread; reports merge by string content
+    typedef std::pair<const char*, int> Key;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<const void*>()(key.first) * 31 + static_cast<size_t>(key.second);
+        }
+    };
+
+    struct ScopeTotals {
+        int64_t calls;
+        int64_t total_ns;
+        int64_t min_ns;
+        int64_t max_ns;
+
+        ScopeTotals()
+            : calls(0), total_ns(0),
+              min_ns(std::numeric_limits<int64_t>::max()), max_ns(0) {}
+
+        void add(int64_t ns) {
+            calls++;
+            total_ns += ns;
+            min_ns = std::min(min_ns, ns);
+            max_ns = std::max(max_ns, ns);
+        }
+
+        void merge(const ScopeTotals& other) {
+            calls += other.calls;
+            total_ns += other.total_ns;
+            min_ns = std::min(min_ns, other.min_ns);
+            max_ns = std::max(max_ns, other.max_ns);
+        }
+    };
+
+    struct HardwareTotals {
+        int64_t calls;
+        int64_t duration_ns;
+        PerfSample counts;
+
+        HardwareTotals() : calls(0), duration_ns(0) {}
+
+        void merge(const HardwareTotals& other) {
+            calls += other.calls;
+            duration_ns += other.duration_ns;
+            counts += other.counts;
+        }
+    };
+
+    struct TraceEvent {
+        const char* name;
+        int tag;
+        int64_t start_ns;
+        int64_t duration_ns;
+    };
+
+    struct ThreadData {
+        int thread_index;
+        std::unordered_map<Key, ScopeTotals, KeyHash> scopes;
+        std::unordered_map<Key, int64_t, KeyHash> counters;
+        std::unordered_map<Key, HardwareTotals, KeyHash> hardware;
+        std::vector<TraceEvent> trace;
+        int64_t dropped_events;
+
+        explicit ThreadData(int index) : thread_index(index), dropped_events(0) {}
+    };
+
+    // Registry keeps each thread's data alive after the thread exits
+    std::mutex registry_mutex;
+    std::vector<std::shared_ptr<ThreadData>> registry;
+    std::vector<std::string> tag_names(1, "");
+    std::map<std::string, int> tag_ids;
+    std::atomic<int64_t> trace_limit(1000000);
+    std::atomic<bool> hardware_enabled(false);
+
+    thread_local std::shared_ptr<ThreadData> local_data;
+    thread_local int current_tag = 0;
+
+    ThreadData& threadData() {
+        if (!local_data) {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            local_data = std::make_shared<ThreadData>(static_cast<int>(registry.size()));
+            registry.push_back(local_data);
+        }
+        return *local_data;
+    }
+
+    std::string escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out += ' ';
+            } else {
+                out += c;
+            }
+        }
+        return out;
+    }
+
+    // (name, tag) -> totals, ordered for stable output
+    typedef std::map<std::pair<std::string, std::string>, ScopeTotals> ScopeTable;
+    typedef std::map<std::pair<std::string, std::string>, int64_t> CounterTable;
+    typedef std::map<std::pair<std::string, std::string>, HardwareTotals> HardwareTable;
+
+    void writeScopes(std::ofstream& file, const ScopeTable& table, const std::string& indent) {
+        file << "[";
+        bool first = true;
+        for (const auto& entry : table) {
+            const ScopeTotals& t = entry.second;
+            file << (first ? "\n" : ",\n") << indent << "  {\"name\": \""
+                 << escape(entry.first.first) << "\"";
+            if (!entry.first.second.empty()) {
+                file << ", \"tag\": \"" << escape(entry.first.second) << "\"";
+            }
+            file << ", \"calls\": " << t.calls
+                 << ", \"total_ms\": " << t.total_ns / 1e6
+                 << ", \"mean_us\": " << (t.calls > 0 ? t.total_ns / 1e3 / t.calls : 0.0)
+                 << ", \"min_us\": " << (t.calls > 0 ? t.min_ns / 1e3 : 0.0)
+                 << ", \"max_us\": " << t.max_ns / 1e3 << "}";
+            first = false;
+        }
+        file << (first ? "]" : "\n" + indent + "]");
+    }
+
+    void writeCounters(std::ofstream& file, const CounterTable& table, const std::string& indent) {
+        file << "[";
+        bool first = true;
+        for (const auto& entry : table) {
+            file << (first ? "\n" : ",\n") << indent << "  {\"name\": \""
+                 << escape(entry.first.first) << "\"";
+            if (!entry.first.second.empty()) {
+                file << ", \"tag\": \"" << escape(entry.first.second) << "\"";
+            }
+            file << ", \"value\": " << entry.second << "}";
+            first = false;
+        }
+        file << (first ? "]" : "\n" + indent + "]");
+    }
+
+    // Derived rates per (scope, tag). Flops come from a "<scope>.flops"
+    // counter under the same tag; peak assumes one core at the measured
+    // clock. Bandwidth counts each last-level miss as one 64-byte line.
+    void writeHardware(std::ofstream& file, const HardwareTable& table,
+                       const CounterTable& counters) {
+        file << "{\"available\": " << (PerfCounters::supported() ? "true" : "false")
+             << ", \"peak_flops_per_cycle\": " << PerfCounters::peakFlopsPerCycle()
+             << ", \"scopes\": [";
+        bool first = true;
+        for (const auto& entry : table) {
+            const HardwareTotals& h = entry.second;
+            const PerfSample& c = h.counts;
+            double seconds = h.duration_ns / 1e9;
+            double ghz = h.duration_ns > 0 ? static_cast<double>(c.cycles) / h.duration_ns : 0.0;
+
+            file << (first ? "\n" : ",\n") << "    {\"name\": \"" << escape(entry.first.first) << "\"";
+            if (!entry.first.second.empty()) {
+                file << ", \"tag\": \"" << escape(entry.first.second) << "\"";
+            }
+            file << ", \"calls\": " << h.calls
+                 << ", \"seconds\": " << seconds
+                 << ", \"cycles\": " << c.cycles
+                 << ", \"instructions\": " << c.instructions
+                 << ", \"ipc\": " << (c.cycles > 0 ? static_cast<double>(c.instructions) / c.cycles : 0.0)
+                 << ", \"ghz\": " << ghz
+                 << ", \"cache_references\": " << c.cache_references
+                 << ", \"cache_misses\": " << c.cache_misses
+                 << ", \"cache_miss_rate\": "
+                 << (c.cache_references > 0 ? static_cast<double>(c.cache_misses) / c.cache_references : 0.0)
+                 << ", \"branch_misses\": " << c.branch_misses
+                 << ", \"bandwidth_gbs\": " << (seconds > 0 ? c.cache_misses * 64.0 / seconds / 1e9 : 0.0);
+
+            auto flops = counters.find(std::make_pair(entry.first.first + ".flops", entry.first.second));
+            if (flops != counters.end() && seconds > 0) {
+                double gflops = flops->second / seconds / 1e9;
+                double peak = ghz * PerfCounters::peakFlopsPerCycle();
+                file << ", \"gflops\": " << gflops
+                     << ", \"peak_gflops\": " << peak
+                     << ", \"peak_fraction\": " << (peak > 0 ? gflops / peak : 0.0);
+            }
+            file << "}";
+            first = false;
+        }
+        file << (first ? "]}" : "\n  ]}");
+    }
+}
+
+namespace Profiler {
+    int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+    }
+
+    void recordScope(const char* name, int64_t start_ns, int64_t end_ns, bool trace) {
+        ThreadData& data = threadData();
+        data.scopes[Key(name, current_tag)].add(end_ns - start_ns);
+
+        if (trace) {
+            if (static_cast<int64_t>(data.trace.size()) < trace_limit.load(std::memory_order_relaxed)) {
+                data.trace.push_back({name, current_tag, start_ns, end_ns - start_ns});
+            } else {
+                data.dropped_events++;
+            }
+        }
+    }
+
+    void recordCount(const char* name, int64_t value) {
+        threadData().counters[Key(name, current_tag)] += value;
+    }
+
+    void setTag(const std::string& tag) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        auto it = tag_ids.find(tag);
+        if (it == tag_ids.end()) {
+            it = tag_ids.emplace(tag, static_cast<int>(tag_names.size())).first;
+            tag_names.push_back(tag);
+        }
+        current_tag = it->second;
+    }
+
+    std::string currentTag() {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        return tag_names[current_tag];
+    }
+
+    void enableHardwareCounters(bool enable) {
+        hardware_enabled.store(enable, std::memory_order_relaxed);
+    }
+
+    bool hardwareCountersEnabled() {
+        return hardware_enabled.load(std::memory_order_relaxed);
+    }
+
+    void recordHardware(const char* name, const PerfSample& delta, int64_t duration_ns) {
+        HardwareTotals& totals = threadData().hardware[Key(name, current_tag)];
+        totals.calls++;
+        totals.duration_ns += duration_ns;
+        totals.counts += delta;
+    }
+
+    void setTraceLimit(int64_t events_per_thread) {
+        trace_limit.store(events_per_thread, std::memory_order_relaxed);
+    }
+
+    bool writeJSON(const std::string& filename) {
+        std::ofstream file(filename);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        file << std::fixed << std::setprecision(3);
+        file << "{\n  \"enabled\": " << (enabled ? "true" : "false") << ",\n";
+
+        ScopeTable all_scopes;
+        CounterTable all_counters;
+        HardwareTable all_hardware;
+
+        file << "  \"threads\": [";
+        for (size_t i = 0; i < registry.size(); i++) {
+            const ThreadData& data = *registry[i];
+            ScopeTable scopes;
+            CounterTable counters;
+            for (const auto& entry : data.scopes) {
+                auto key = std::make_pair(std::string(entry.first.first), tag_names[entry.first.second]);
+                scopes[key].merge(entry.second);
+                all_scopes[key].merge(entry.second);
+            }
+            for (const auto& entry : data.counters) {
+                auto key = std::make_pair(std::string(entry.first.first), tag_names[entry.first.second]);
+                counters[key] += entry.second;
+                all_counters[key] += entry.second;
+            }
+            for (const auto& entry : data.hardware) {
+                auto key = std::make_pair(std::string(entry.first.first), tag_names[entry.first.second]);
+                all_hardware[key].merge(entry.second);
+            }
+
+            file << (i == 0 ? "\n" : ",\n") << "    {\"thread\": " << data.thread_index
+                 << ", \"dropped_trace_events\": " << data.dropped_events
+                 << ",\n      \"scopes\": ";
+            writeScopes(file, scopes, "      ");
+            file << ",\n      \"counters\": ";
+            writeCounters(file, counters, "      ");
+            file << "}";
+        }
+        file << (registry.empty() ? "],\n" : "\n  ],\n");
+
+        // Per-tag view across threads, then untagged totals per scope
+        file << "  \"by_tag\": ";
+        writeScopes(file, all_scopes, "  ");
+        file << ",\n  \"counters_by_tag\": ";
+        writeCounters(file, all_counters, "  ");
+
+        ScopeTable totals;
+        CounterTable counter_totals;
+        for (const auto& entry : all_scopes) {
+            totals[std::make_pair(entry.first.first, std::string())].merge(entry.second);
+        }
+        for (const auto& entry : all_counters) {
+            counter_totals[std::make_pair(entry.first.first, std::string())] += entry.second;
+        }
+        file << ",\n  \"totals\": ";
+        writeScopes(file, totals, "  ");
+        file << ",\n  \"counter_totals\": ";
+        writeCounters(file, counter_totals, "  ");
+
+        if (hardwareCountersEnabled()) {
+            file << ",\n  \"hardware\": ";
+            writeHardware(file, all_hardware, all_counters);
+        }
+        file << "\n}\n";
+
+        return true;
+    }
+
+    bool writeChromeTrace(const std::string& filename) {
+        std::ofstream file(filename);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        file << std::fixed << std::setprecision(3);
+        file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+        bool first = true;
+        for (const auto& data : registry) {
+            file << (first ? "\n" : ",\n")
+                 << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": "
+                 << data->thread_index << ", \"args\": {\"name\": \""
+                 << "thread " << data->thread_index
+                 << "\"}}";
+            first = false;
+
+            for (const TraceEvent& event : data->trace) {
+                file << ",\n{\"name\": \"" << escape(event.name)
+                     << "\", \"cat\": \"" << escape(tag_names[event.tag])
+                     << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << data->thread_index
+                     << ", \"ts\": " << event.start_ns / 1e3
+                     << ", \"dur\": " << event.duration_ns / 1e3 << "}";
+            }
+        }
+        file << "\n]}\n";
+
+        return true;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (auto& data : registry) {
+            data->scopes.clear();
+            data->counters.clear();
+            data->hardware.clear();
+            data->trace.clear();
+            data->dropped_events = 0;
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include "results.h"
+#include "profiler.h"
 #include <iostream>
 #include <fstream>
 #include <iomanip>
@@ -56,6 +57,7 @@ void ExperimentResult::print() const {
 }
 
 void ExperimentResult::saveToFile(const std::string& filename) const {
+    PROFILE_TRACE("results.write");
     std::ofstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error: Cannot open file " << filename << std::endl;
@@ -69,17 +71,26 @@ void ExperimentResult::saveToFile(const std::string& filename) const {
         file << network_structure[i];
         if (i < network_structure.size() - 1) file << "-";
     }
+    file << "\nActivation: " << activation;
+    if (warm_start) {
+        file << "\nWarm Start: yes (folds are not independent)";
+    }
     file << "\n\n";
     
     file << std::fixed << std::setprecision(4);
-    file << "Fold,Train_Accuracy,Test_Accuracy,Generations,Best_Fitness\n";
+    file << "Fold,Train_Accuracy,Test_Accuracy,Generations,Best_Fitness,"
+         << "Evaluations,Stop_Reason,Initialization,Inputs\n";
     
     for (const auto& fold : fold_results) {
         file << fold.fold_number << ","
              << fold.train_accuracy << ","
              << fold.test_accuracy << ","
              << fold.generations_used << ","
-             << fold.best_fitness << "\n";
+             << fold.best_fitness << ","
+             << fold.evaluations_used << ","
+             << fold.stop_reason << ","
+             << fold.initialization << ","
+             << fold.inputs << "\n";
     }
     
     file << "\nMean Train Accuracy," << mean_train_accuracy << "\n";
@@ -132,7 +143,54 @@ void ResultsManager::printComparison() const {
     std::cout << "\n  Test Accuracy: " << best->mean_test_accuracy * 100 << "%\n";
 }
 
-void ResultsManager::saveAllResults(const std::string& filename) const {
+void ResultsManager::printWarmStartSavings() const {
+    long cold_folds = 0, warm_folds = 0;
+    double cold_generations = 0.0, warm_generations = 0.0;
+    double cold_to_reference = 0.0, warm_to_reference = 0.0;
+    double cold_accuracy = 0.0, warm_accuracy = 0.0;
+    for (const auto& exp : experiments) {
+        for (const auto& fold : exp.fold_results) {
+            if (fold.initialization == "random") {
+                cold_folds++;
+                cold_generations += fold.generations_used;
+                cold_to_reference += fold.generations_to_reference;
+                cold_accuracy += fold.test_accuracy;
+            } else {
+                warm_folds++;
+                warm_generations += fold.generations_used;
+                warm_to_reference += fold.generations_to_reference;
+                warm_accuracy += fold.test_accuracy;
+            }
+        }
+    }
+    if (warm_folds == 0) return;
+    
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "WARM START (folds are not independent)\n";
+    std::cout << std::string(80, '=') << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Warm-started folds: " << warm_folds << ", mean generations "
+              << warm_generations / warm_folds << ", mean test accuracy "
+              << std::setprecision(4) << 100.0 * warm_accuracy / warm_folds << "%\n";
+    if (cold_folds > 0) {
+        std::cout << std::setprecision(1);
+        std::cout << "Random-init folds:  " << cold_folds << ", mean generations "
+                  << cold_generations / cold_folds << ", mean test accuracy "
+                  << std::setprecision(4) << 100.0 * cold_accuracy / cold_folds << "%\n";
+        
+        // Generations needed to reach the random-init fold's final fitness
+        double cold_mean = cold_to_reference / cold_folds;
+        double warm_mean = warm_to_reference / warm_folds;
+        std::cout << std::setprecision(1);
+        std::cout << "Generations to reach the first fold's best fitness: "
+                  << warm_mean << " warm vs " << cold_mean << " random ("
+                  << (cold_mean > 0 ? 100.0 * (1.0 - warm_mean / cold_mean) : 0.0)
+                  << "% saved)\n";
+    }
+}
+
+void ResultsManager::saveAllResults(const std::string& filename, int plan_experiments) const {
+    PROFILE_TRACE("results.write");
     std::ofstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error: Cannot open file " << filename << std::endl;
@@ -141,10 +199,15 @@ void ResultsManager::saveAllResults(const std::string& filename) const {
     
     file << std::fixed << std::setprecision(6);
     
+    const bool with_plan_index = plan_experiments > 0;
+    if (with_plan_index) {
+        file << "#Plan_Experiments," << plan_experiments << "\n" << "Experiment,";
+    }
     file << "Run_ID,Seed,Architecture,Fold,Train_Accuracy,Test_Accuracy,"
          << "Generations,Best_Fitness,"
          << "Train_TP,Train_TN,Train_FP,Train_FN,Train_Precision,Train_Recall,Train_F1,"
-         << "Test_TP,Test_TN,Test_FP,Test_FN,Test_Precision,Test_Recall,Test_F1\n";
+         << "Test_TP,Test_TN,Test_FP,Test_FN,Test_Precision,Test_Recall,Test_F1,"
+         << "Evaluations,Stop_Reason,Activation,Initialization,Inputs\n";
     
     for (const auto& exp : experiments) {
         std::string arch_str;
@@ -154,6 +217,7 @@ void ResultsManager::saveAllResults(const std::string& filename) const {
         }
         
         for (const auto& fold : exp.fold_results) {
+            if (with_plan_index) file << exp.plan_index << ",";
             file << exp.run_id << ","
                  << exp.seed << ","
                  << arch_str << ","
@@ -175,7 +239,12 @@ void ResultsManager::saveAllResults(const std::string& filename) const {
                  << fold.test_metrics.false_negative << ","
                  << fold.test_metrics.precision << ","
                  << fold.test_metrics.recall << ","
-                 << fold.test_metrics.f1_score << "\n";
+                 << fold.test_metrics.f1_score << ","
+                 << fold.evaluations_used << ","
+                 << fold.stop_reason << ","
+                 << exp.activation << ","
+                 << fold.initialization << ","
+                 << fold.inputs << "\n";
         }
     }
     
@@ -183,7 +252,8 @@ void ResultsManager::saveAllResults(const std::string& filename) const {
     std::cout << "Detailed results saved to " << filename << std::endl;
 }
 
-void ResultsManager::saveSummaryResults(const std::string& filename) const {
+void ResultsManager::saveSummaryResults(const std::string& filename, int plan_experiments) const {
+    PROFILE_TRACE("results.write");
     std::ofstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error: Cannot open file " << filename << std::endl;
@@ -191,10 +261,14 @@ void ResultsManager::saveSummaryResults(const std::string& filename) const {
     }
     
     file << std::fixed << std::setprecision(6);
+    const bool with_plan_index = plan_experiments > 0;
+    if (with_plan_index) {
+        file << "#Plan_Experiments," << plan_experiments << "\n" << "Experiment,";
+    }
     file << "Run_ID,Seed,Architecture,Mean_Test_Accuracy,Std_Test_Accuracy,"
          << "Mean_Train_Accuracy,Std_Train_Accuracy,"
          << "Min_Test_Acc,Max_Test_Acc,Median_Test_Acc,"
-         << "Mean_Precision,Mean_Recall,Mean_F1\n";
+         << "Mean_Precision,Mean_Recall,Mean_F1,Activation,Warm_Start\n";
     
     for (const auto& exp : experiments) {
         std::string arch_str;
@@ -222,6 +296,7 @@ void ResultsManager::saveSummaryResults(const std::string& filename) const {
         double mean_recall = sum_recall / exp.fold_results.size();
         double mean_f1 = sum_f1 / exp.fold_results.size();
         
+        if (with_plan_index) file << exp.plan_index << ",";
         file << exp.run_id << ","
              << exp.seed << ","
              << arch_str << ","
@@ -234,7 +309,9 @@ void ResultsManager::saveSummaryResults(const std::string& filename) const {
              << median_acc << ","
              << mean_precision << ","
              << mean_recall << ","
-             << mean_f1 << "\n";
+             << mean_f1 << ","
+             << exp.activation << ","
+             << (exp.warm_start ? 1 : 0) << "\n";
     }
     
     file.close();
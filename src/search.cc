@@ -0,0 +1,210 @@
+#include "search.h"
+#include "utils.h"
+#include "metrics.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <random>
+
+ArchitectureSearch::ArchitectureSearch(const SweepSpec& sweep_spec, const Dataset& data,
+                                       SweepRunner& sweep_runner)
+    : spec(sweep_spec), dataset(data), runner(sweep_runner),
+      generations_spent(0), num_rungs(1) {
+    for (const auto& arch : spec.architectures) {
+        for (ActivationType act : spec.activations) {
+            candidates.push_back({arch, act});
+        }
+    }
+
+    // K = floor(log_eta(candidates)) halvings leave a single survivor
+    long long reach = spec.search.eta;
+    while (reach <= static_cast<long long>(candidates.size())) {
+        num_rungs++;
+        reach *= spec.search.eta;
+    }
+}
+
+int ArchitectureSearch::maxGenerations() const {
+    return spec.optimizer_type == OptimizerType::SEP_CMAES
+        ? spec.cmaes_config.max_generations
+        : spec.ga_config.max_generations;
+}
+
+int ArchitectureSearch::rungGenerations(int rung) const {
+    double scale = std::pow(spec.search.eta, num_rungs - 1 - rung);
+    int generations = static_cast<int>(std::lround(maxGenerations() / scale));
+    return std::min(maxGenerations(), std::max(spec.search.min_generations, generations));
+}
+
+int ArchitectureSearch::rungRuns(int rung) const {
+    double scale = std::pow(spec.search.eta, num_rungs - 1 - rung);
+    int runs = static_cast<int>(std::lround(spec.num_runs / scale));
+    return std::min(spec.num_runs, std::max(spec.search.min_runs, runs));
+}
+
+std::string ArchitectureSearch::candidateName(const Candidate& candidate) {
+    return Utils::architectureName(candidate.architecture) + "/" +
+           activationTypeName(candidate.activation);
+}
+
+long long ArchitectureSearch::gridGenerationBudget() const {
+    return static_cast<long long>(candidates.size()) * spec.num_runs *
+           spec.num_folds * maxGenerations();
+}
+
+std::vector<double> ArchitectureSearch::evaluateRung(const std::vector<Candidate>& rung_candidates,
+                                                     int rung, ResultsManager& results_manager) {
+    const int runs = rungRuns(rung);
+    const int generations = rungGenerations(rung);
+    const bool full_budget = runs == spec.num_runs && generations == maxGenerations();
+    const std::string budget = "@" + std::to_string(runs) + "x" + std::to_string(generations);
+
+    // Hyperband brackets overlap; only run what no earlier rung has
+    std::vector<Candidate> todo;
+    for (const Candidate& candidate : rung_candidates) {
+        if (rung_cache.count(candidateName(candidate) + budget) == 0) {
+            todo.push_back(candidate);
+        }
+    }
+
+    if (!todo.empty()) {
+        std::cout << "\nRung " << rung << ": " << todo.size() << " candidates x "
+                  << runs << " runs x " << generations << " generations\n";
+
+        SweepPlan plan = SweepPlan::expand(spec, dataset, todo, runs, generations);
+        SweepMetrics::global().experiments_total += static_cast<long>(plan.experiments.size());
+
+        ResultsManager rung_results;
+        runner.run(plan, rung_results, false);
+
+        // Plan order is run-major: experiment e belongs to todo[e % size]
+        std::vector<std::vector<ExperimentResult>> by_candidate(todo.size());
+        const auto& experiments = rung_results.getExperiments();
+        for (size_t e = 0; e < experiments.size(); e++) {
+            for (const auto& fold : experiments[e].fold_results) {
+                generations_spent += fold.generations_used;
+            }
+            by_candidate[e % todo.size()].push_back(experiments[e]);
+        }
+        for (size_t c = 0; c < todo.size(); c++) {
+            double sum = 0.0;
+            for (const auto& exp : by_candidate[c]) {
+                sum += exp.mean_test_accuracy;
+            }
+            std::string name = candidateName(todo[c]);
+            rung_cache[name + budget] = sum / by_candidate[c].size();
+            if (full_budget) {
+                full_results[name] = std::move(by_candidate[c]);
+            }
+        }
+    }
+
+    std::vector<double> scores;
+    for (const Candidate& candidate : rung_candidates) {
+        std::string name = candidateName(candidate);
+        scores.push_back(rung_cache[name + budget]);
+        if (full_budget && finalists.insert(name).second) {
+            for (const auto& exp : full_results[name]) {
+                results_manager.addExperiment(exp);
+            }
+        }
+    }
+    return scores;
+}
+
+void ArchitectureSearch::runBracket(int bracket, std::vector<Candidate> bracket_candidates,
+                                    int first_rung, ResultsManager& results_manager) {
+    for (int rung = first_rung; rung < num_rungs; rung++) {
+        std::vector<double> scores = evaluateRung(bracket_candidates, rung, results_manager);
+
+        const bool last = rung == num_rungs - 1;
+        size_t keep = last ? 0 : (bracket_candidates.size() + spec.search.eta - 1) / spec.search.eta;
+
+        // Rank by mean CV test accuracy; ties keep spec order
+        std::vector<size_t> order(bracket_candidates.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](size_t a, size_t b) { return scores[a] > scores[b]; });
+
+        std::vector<Candidate> survivors;
+        for (size_t i = 0; i < order.size(); i++) {
+            const Candidate& candidate = bracket_candidates[order[i]];
+            bool promoted = i < keep;
+            records.push_back({bracket, rung, candidate, rungRuns(rung), rungGenerations(rung),
+                               scores[order[i]], promoted});
+            if (promoted) {
+                survivors.push_back(candidate);
+            }
+        }
+        bracket_candidates = std::move(survivors);
+    }
+}
+
+void ArchitectureSearch::run(ResultsManager& results_manager) {
+    const int K = num_rungs - 1;
+    if (spec.search.mode == SearchMode::SUCCESSIVE_HALVING) {
+        runBracket(0, candidates, 0, results_manager);
+        return;
+    }
+
+    // Hyperband: bracket s starts ceil((K+1)/(s+1) * eta^s) random
+    // candidates at rung K - s, from most exploratory to plain full budget
+    std::mt19937 shuffle_rng(spec.base_seed);
+    for (int s = K; s >= 0; s--) {
+        double n = std::ceil((K + 1.0) / (s + 1.0) * std::pow(spec.search.eta, s));
+        size_t count = std::min(candidates.size(), static_cast<size_t>(n));
+
+        std::vector<Candidate> pool = candidates;
+        std::shuffle(pool.begin(), pool.end(), shuffle_rng);
+        pool.resize(count);
+
+        std::cout << "\nHyperband bracket " << (K - s) << ": " << count
+                  << " candidates from rung " << (K - s) << "\n";
+        runBracket(K - s, pool, K - s, results_manager);
+    }
+}
+
+void ArchitectureSearch::printReport() const {
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "ARCHITECTURE SEARCH (" << searchModeName(spec.search.mode)
+              << ", eta " << spec.search.eta << ")\n";
+    std::cout << std::string(80, '=') << "\n";
+
+    std::cout << std::fixed << std::setprecision(4);
+    for (const RungRecord& r : records) {
+        if (r.rung != num_rungs - 1 && !r.promoted) continue;
+        std::cout << "Bracket " << r.bracket << " rung " << r.rung << " ("
+                  << r.runs << " runs x " << r.generations << " gens): "
+                  << std::left << std::setw(24) << candidateName(r.candidate) << std::right
+                  << " " << (r.mean_test_accuracy * 100) << "%"
+                  << (r.promoted ? " -> promoted" : "") << "\n";
+    }
+
+    long long budget = gridGenerationBudget();
+    std::cout << std::setprecision(1);
+    std::cout << "Generations run: " << generations_spent << " of " << budget
+              << " budgeted by the full grid ("
+              << (budget > 0 ? 100.0 * generations_spent / budget : 0.0) << "%)\n";
+}
+
+void ArchitectureSearch::saveLog(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return;
+    }
+
+    file << std::fixed << std::setprecision(6);
+    file << "Bracket,Rung,Architecture,Activation,Runs,Generations,"
+         << "Mean_Test_Accuracy,Promoted\n";
+    for (const RungRecord& r : records) {
+        file << r.bracket << "," << r.rung << ","
+             << Utils::architectureName(r.candidate.architecture) << ","
+             << activationTypeName(r.candidate.activation) << ","
+             << r.runs << "," << r.generations << ","
+             << r.mean_test_accuracy << "," << (r.promoted ? 1 : 0) << "\n";
+    }
+}
@@ -0,0 +1,141 @@
+#include "shard.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+ShardSpec ShardSpec::parse(const std::string& text) {
+    ShardSpec shard;
+    size_t slash = text.find('/');
+    try {
+        if (slash == std::string::npos) throw std::invalid_argument(text);
+        size_t used = 0;
+        shard.index = std::stoi(text.substr(0, slash), &used);
+        if (used != slash) throw std::invalid_argument(text);
+        shard.count = std::stoi(text.substr(slash + 1), &used);
+        if (used != text.size() - slash - 1) throw std::invalid_argument(text);
+    } catch (const std::exception&) {
+        throw std::invalid_argument("shard must look like i/N, got \"" + text + "\"");
+    }
+    if (shard.count < 1 || shard.index < 1 || shard.index > shard.count) {
+        throw std::invalid_argument("shard i/N needs 1 <= i <= N, got \"" + text + "\"");
+    }
+    return shard;
+}
+
+std::string ShardSpec::fileName(const std::string& base) const {
+    size_t dot = base.rfind('.');
+    std::string stem = dot == std::string::npos ? base : base.substr(0, dot);
+    std::string extension = dot == std::string::npos ? "" : base.substr(dot);
+    return stem + "_shard_" + std::to_string(index) + "_of_" + std::to_string(count) + extension;
+}
+
+namespace {
+
+struct ShardRow {
+    int experiment;
+    std::string text;    // the row without the Experiment column
+};
+
+} // namespace
+
+void mergeShardFiles(const std::string& directory, const std::string& base, int count,
+                     const std::string& output) {
+    const std::string plan_prefix = "#Plan_Experiments,";
+    std::string header;
+    int plan_experiments = 0;
+    std::vector<ShardRow> rows;
+    ShardSpec shard;
+    shard.count = count;
+    for (shard.index = 1; shard.index <= count; shard.index++) {
+        std::string path = (directory.empty() ? "" : directory + "/") + shard.fileName(base);
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            throw std::runtime_error("missing shard file " + path);
+        }
+        std::string line;
+        int experiments = 0;
+        if (std::getline(file, line) && line.compare(0, plan_prefix.size(), plan_prefix) == 0) {
+            try {
+                experiments = std::stoi(line.substr(plan_prefix.size()));
+            } catch (const std::exception&) {
+            }
+        }
+        if (experiments < 1) {
+            throw std::runtime_error(path + " is not a shard file (no " + plan_prefix +
+                                     "M line)");
+        }
+        if (shard.index == 1) {
+            plan_experiments = experiments;
+        } else if (experiments != plan_experiments) {
+            throw std::runtime_error(path + " is from a plan of " + std::to_string(experiments) +
+                                     " experiments, shard 1 from one of " +
+                                     std::to_string(plan_experiments));
+        }
+        if (!std::getline(file, line) || line.compare(0, 11, "Experiment,") != 0) {
+            throw std::runtime_error(path + " is not a shard file (no Experiment column)");
+        }
+        if (shard.index == 1) {
+            header = line.substr(11);
+        } else if (line.substr(11) != header) {
+            throw std::runtime_error(path + " has a different header than shard 1");
+        }
+        // An experiment's rows are written as one block; seeing it again
+        // after another experiment means the file holds it twice
+        std::vector<bool> seen(plan_experiments, false);
+        int previous = -1;
+        while (std::getline(file, line)) {
+            if (line.empty()) continue;
+            size_t comma = line.find(',');
+            ShardRow row;
+            try {
+                row.experiment = std::stoi(line.substr(0, comma));
+            } catch (const std::exception&) {
+                throw std::runtime_error(path + ": bad experiment index in \"" + line + "\"");
+            }
+            if (comma == std::string::npos || row.experiment < 0 ||
+                row.experiment >= plan_experiments || !shard.owns(row.experiment)) {
+                throw std::runtime_error(path + ": experiment " + std::to_string(row.experiment) +
+                                         " does not belong to this shard");
+            }
+            if (row.experiment != previous) {
+                if (seen[row.experiment]) {
+                    throw std::runtime_error(path + ": experiment " +
+                                             std::to_string(row.experiment) +
+                                             " appears in more than one block");
+                }
+                seen[row.experiment] = true;
+                previous = row.experiment;
+            }
+            row.text = line.substr(comma + 1);
+            rows.push_back(std::move(row));
+        }
+    }
+
+    // An experiment's rows come from one shard, already in fold order
+    std::stable_sort(rows.begin(), rows.end(), [](const ShardRow& a, const ShardRow& b) {
+        return a.experiment < b.experiment;
+    });
+
+    // Every experiment 0..M-1 of the plan must be present
+    std::vector<bool> present(plan_experiments, false);
+    for (const ShardRow& row : rows) {
+        present[row.experiment] = true;
+    }
+    for (int experiment = 0; experiment < plan_experiments; experiment++) {
+        if (!present[experiment]) {
+            throw std::runtime_error("experiment " + std::to_string(experiment) + " of " +
+                                     std::to_string(plan_experiments) +
+                                     " is missing from the shards of " + base);
+        }
+    }
+
+    std::ofstream out(output);
+    if (!out.is_open()) {
+        throw std::runtime_error("cannot write " + output);
+    }
+    out << header << "\n";
+    for (const ShardRow& row : rows) {
+        out << row.text << "\n";
+    }
+}
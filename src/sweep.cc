@@ -0,0 +1,932 @@
+#include "sweep.h"
+#include "utils.h"
+#include "profiler.h"
+#include "metrics.h"
+#include "packed_mlp.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <functional>
+
+SearchMode parseSearchMode(const std::string& name) {
+    if (name == "grid") return SearchMode::GRID;
+    if (name == "successive_halving") return SearchMode::SUCCESSIVE_HALVING;
+    if (name == "hyperband") return SearchMode::HYPERBAND;
+    throw std::invalid_argument("Unknown search mode: " + name);
+}
+
+std::string searchModeName(SearchMode mode) {
+    switch (mode) {
+        case SearchMode::GRID:
+            return "grid";
+        case SearchMode::SUCCESSIVE_HALVING:
+            return "successive_halving";
+        case SearchMode::HYPERBAND:
+            return "hyperband";
+    }
+    return "grid";
+}
+
+SweepSpec::SweepSpec()
+    : dataset_path("data/wdbc.data"),
+      num_folds(10),
+      num_runs(100),
+      first_run(1),
+      base_seed(42),
+      seed_stride(1000),
+      threads(0),
+      checkpoint_every(10),
+      activations(1, ActivationType::SIGMOID),
+      optimizer_type(OptimizerType::GA),
+      // Accuracy with a margin tie-break keeps selection pressure among
+      // individuals that classify the same number of samples correctly
+      fitness_type(FitnessType::ACCURACY_MARGIN),
+      packed_evaluation(false),
+      fold_normalization(false),
+      numa(false) {
+    architectures = {
+        // 1 hidden layer (neurons: 5-50)
+        {30, 5, 1}, {30, 8, 1}, {30, 10, 1}, {30, 12, 1}, {30, 15, 1},
+        {30, 18, 1}, {30, 20, 1}, {30, 25, 1}, {30, 30, 1}, {30, 40, 1}, {30, 50, 1},
+
+        // 2 hidden layers
+        {30, 20, 10, 1}, {30, 25, 15, 1}, {30, 30, 15, 1}, {30, 20, 5, 1},
+        {30, 15, 10, 1}, {30, 15, 5, 1}, {30, 10, 5, 1}, {30, 25, 10, 1},
+        {30, 30, 20, 1}, {30, 40, 20, 1}, {30, 25, 5, 1},
+
+        // 3 hidden layers
+        {30, 20, 15, 10, 1}, {30, 25, 20, 10, 1}, {30, 30, 20, 10, 1},
+        {30, 20, 10, 5, 1}, {30, 15, 10, 5, 1}, {30, 25, 15, 5, 1},
+        {30, 30, 15, 5, 1}, {30, 40, 20, 10, 1},
+
+        // 4 hidden layers
+        {30, 30, 20, 10, 5, 1}, {30, 25, 20, 15, 10, 1},
+        {30, 20, 15, 10, 5, 1}, {30, 40, 30, 20, 10, 1}
+    };
+
+    ga_config.population_size = 50;
+    ga_config.max_generations = 100;
+    ga_config.crossover_rate = 0.8;
+    ga_config.mutation_rate = 0.15;
+    ga_config.mutation_strength = 0.3;
+    ga_config.mutation_type = MutationType::GAUSSIAN;
+    ga_config.elitism_rate = 0.1;
+    ga_config.tournament_size = 3;
+    ga_config.local_search_elites = 2;
+    ga_config.local_search_steps = 5;
+    ga_config.local_search_rate = 0.5;
+    ga_config.verbose = false;
+
+    cmaes_config.max_generations = ga_config.max_generations;
+    cmaes_config.initial_sigma = 0.5;
+    cmaes_config.verbose = false;
+
+    // Stop folds that have converged instead of burning the full budget
+    stopping.target_fitness = 1.0;
+    stopping.stagnation_generations = 30;
+}
+
+SweepSpec SweepSpec::fromJSON(const JsonValue& json) {
+    SweepSpec spec;
+    json.checkKeys({"dataset", "folds", "runs", "first_run", "seed", "seed_stride",
+                    "threads", "checkpoint_every", "architectures", "activations",
+                    "optimizer", "fitness", "ga", "cmaes", "stopping", "restart", "search",
+                    "warm_start", "packed_evaluation", "features", "reduction",
+                    "normalization", "numa"}, "sweep spec");
+
+    spec.dataset_path = json.getString("dataset", spec.dataset_path);
+    spec.num_folds = json.getInt("folds", spec.num_folds);
+    spec.num_runs = json.getInt("runs", spec.num_runs);
+    spec.first_run = json.getInt("first_run", spec.first_run);
+    spec.base_seed = static_cast<unsigned int>(json.getLong("seed", spec.base_seed));
+    spec.seed_stride = static_cast<unsigned int>(json.getLong("seed_stride", spec.seed_stride));
+    spec.threads = json.getInt("threads", spec.threads);
+    spec.checkpoint_every = json.getInt("checkpoint_every", spec.checkpoint_every);
+    spec.packed_evaluation = json.getBool("packed_evaluation", spec.packed_evaluation);
+    spec.numa = json.getBool("numa", spec.numa);
+    if (json.has("features")) {
+        spec.features = FeaturePipeline::fromJSON(json["features"]);
+    }
+    if (json.has("normalization")) {
+        std::string mode = json["normalization"].asString();
+        if (mode != "global" && mode != "fold") {
+            throw std::invalid_argument("normalization must be \"global\" or \"fold\"");
+        }
+        spec.fold_normalization = mode == "fold";
+    }
+
+    if (json.has("architectures")) {
+        spec.architectures.clear();
+        for (const auto& arch : json["architectures"].asArray()) {
+            std::vector<int> layers;
+            for (const auto& width : arch.asArray()) {
+                layers.push_back(width.asInt());
+            }
+            spec.architectures.push_back(layers);
+        }
+    }
+    if (json.has("activations")) {
+        spec.activations.clear();
+        for (const auto& name : json["activations"].asArray()) {
+            spec.activations.push_back(parseActivationType(name.asString()));
+        }
+    }
+    if (json.has("optimizer")) {
+        spec.optimizer_type = parseOptimizerType(json["optimizer"].asString());
+    }
+    if (json.has("fitness")) {
+        spec.fitness_type = parseFitnessType(json["fitness"].asString());
+    }
+
+    if (json.has("ga")) {
+        const JsonValue& ga = json["ga"];
+        ga.checkKeys({"population_size", "max_generations", "crossover_rate", "mutation_rate",
+                      "mutation_strength", "mutation_type", "min_step_size", "elitism_rate",
+                      "tournament_size", "local_search_elites", "local_search_steps",
+                      "local_search_rate"}, "ga");
+        GAConfig& c = spec.ga_config;
+        c.population_size = ga.getInt("population_size", c.population_size);
+        c.max_generations = ga.getInt("max_generations", c.max_generations);
+        c.crossover_rate = ga.getNumber("crossover_rate", c.crossover_rate);
+        c.mutation_rate = ga.getNumber("mutation_rate", c.mutation_rate);
+        c.mutation_strength = ga.getNumber("mutation_strength", c.mutation_strength);
+        if (ga.has("mutation_type")) {
+            c.mutation_type = parseMutationType(ga["mutation_type"].asString());
+        }
+        c.min_step_size = ga.getNumber("min_step_size", c.min_step_size);
+        c.elitism_rate = ga.getNumber("elitism_rate", c.elitism_rate);
+        c.tournament_size = ga.getInt("tournament_size", c.tournament_size);
+        c.local_search_elites = ga.getInt("local_search_elites", c.local_search_elites);
+        c.local_search_steps = ga.getInt("local_search_steps", c.local_search_steps);
+        c.local_search_rate = ga.getNumber("local_search_rate", c.local_search_rate);
+    }
+
+    // CMA-ES follows the GA generation budget unless given its own
+    spec.cmaes_config.max_generations = spec.ga_config.max_generations;
+    if (json.has("cmaes")) {
+        const JsonValue& cm = json["cmaes"];
+        cm.checkKeys({"population_size", "max_generations", "initial_sigma", "initial_range"}, "cmaes");
+        CMAESConfig& c = spec.cmaes_config;
+        c.population_size = cm.getInt("population_size", c.population_size);
+        c.max_generations = cm.getInt("max_generations", c.max_generations);
+        c.initial_sigma = cm.getNumber("initial_sigma", c.initial_sigma);
+        c.initial_range = cm.getNumber("initial_range", c.initial_range);
+    }
+
+    if (json.has("stopping")) {
+        const JsonValue& st = json["stopping"];
+        st.checkKeys({"stagnation_generations", "stagnation_tolerance", "min_diversity",
+                      "target_fitness", "max_evaluations", "max_seconds"}, "stopping");
+        StoppingCriteria& s = spec.stopping;
+        s.stagnation_generations = st.getInt("stagnation_generations", s.stagnation_generations);
+        s.stagnation_tolerance = st.getNumber("stagnation_tolerance", s.stagnation_tolerance);
+        s.min_diversity = st.getNumber("min_diversity", s.min_diversity);
+        s.target_fitness = st.getNumber("target_fitness", s.target_fitness);
+        s.max_evaluations = st.getLong("max_evaluations", s.max_evaluations);
+        s.max_seconds = st.getNumber("max_seconds", s.max_seconds);
+    }
+
+    if (json.has("restart")) {
+        const JsonValue& re = json["restart"];
+        re.checkKeys({"min_gene_variance", "min_disagreement", "max_restarts"}, "restart");
+        RestartCriteria& r = spec.restart;
+        r.min_gene_variance = re.getNumber("min_gene_variance", r.min_gene_variance);
+        r.min_disagreement = re.getNumber("min_disagreement", r.min_disagreement);
+        r.max_restarts = re.getInt("max_restarts", r.max_restarts);
+    }
+
+    if (json.has("search")) {
+        const JsonValue& se = json["search"];
+        se.checkKeys({"mode", "eta", "min_generations", "min_runs"}, "search");
+        SearchConfig& c = spec.search;
+        if (se.has("mode")) {
+            c.mode = parseSearchMode(se["mode"].asString());
+        }
+        c.eta = se.getInt("eta", c.eta);
+        c.min_generations = se.getInt("min_generations", c.min_generations);
+        c.min_runs = se.getInt("min_runs", c.min_runs);
+    }
+
+    if (json.has("warm_start")) {
+        const JsonValue& ws = json["warm_start"];
+        ws.checkKeys({"enabled", "elites", "random_fraction", "perturbation", "bank"}, "warm_start");
+        WarmStartConfig& c = spec.warm_start;
+        c.enabled = ws.getBool("enabled", true);
+        c.elites = ws.getInt("elites", c.elites);
+        c.random_fraction = ws.getNumber("random_fraction", c.random_fraction);
+        c.perturbation = ws.getNumber("perturbation", c.perturbation);
+        c.bank_file = ws.getString("bank", c.bank_file);
+    }
+
+    if (json.has("reduction")) {
+        const JsonValue& re = json["reduction"];
+        re.checkKeys({"method", "components", "population", "generations"}, "reduction");
+        InputReductionConfig& c = spec.reduction;
+        c.method = parseReductionMethod(re.getString("method", "pca"));
+        c.components = re.getInt("components", c.components);
+        c.mask_population = re.getInt("population", c.mask_population);
+        c.mask_generations = re.getInt("generations", c.mask_generations);
+    }
+
+    return spec;
+}
+
+SweepSpec SweepSpec::fromFile(const std::string& filename) {
+    return fromJSON(JsonValue::parseFile(filename));
+}
+
+void SweepSpec::validate(const Dataset& dataset) const {
+    if (num_folds < 2 || num_folds > dataset.getNumSamples()) {
+        throw std::invalid_argument("folds must be in [2, number of samples]");
+    }
+    if (num_runs < 1) {
+        throw std::invalid_argument("runs must be at least 1");
+    }
+    if (architectures.empty() || activations.empty()) {
+        throw std::invalid_argument("sweep needs at least one architecture and activation");
+    }
+    if (search.eta < 2 || search.min_generations < 1 || search.min_runs < 1) {
+        throw std::invalid_argument("search needs eta >= 2 and positive minimum budgets");
+    }
+    if (warm_start.elites < 1 || warm_start.random_fraction < 0.0 ||
+        warm_start.random_fraction >= 1.0 || warm_start.perturbation < 0.0) {
+        throw std::invalid_argument("warm_start needs elites >= 1, random_fraction in [0, 1) "
+                                    "and a non-negative perturbation");
+    }
+    if (fold_normalization && features.fitsStatistics()) {
+        // They would be fitted on every sample, test folds included
+        throw std::invalid_argument("\"normalization\": \"fold\" cannot be combined with "
+                                    "standardize or pca feature stages (use \"reduction\" "
+                                    "for per-fold PCA)");
+    }
+    const GAConfig& ga = ga_config;
+    if (ga.population_size < 2 || ga.max_generations < 1 || ga.tournament_size < 1) {
+        throw std::invalid_argument("ga needs population_size >= 2, max_generations >= 1 "
+                                    "and tournament_size >= 1");
+    }
+    if (ga.crossover_rate < 0.0 || ga.crossover_rate > 1.0 ||
+        ga.mutation_rate < 0.0 || ga.mutation_rate > 1.0 ||
+        ga.elitism_rate < 0.0 || ga.elitism_rate > 1.0) {
+        throw std::invalid_argument("ga crossover_rate, mutation_rate and elitism_rate "
+                                    "must be in [0, 1]");
+    }
+    if (ga.mutation_strength < 0.0 || ga.min_step_size < 0.0) {
+        throw std::invalid_argument("ga mutation_strength and min_step_size must be "
+                                    "non-negative");
+    }
+    if (ga.local_search_elites < 0 || ga.local_search_elites > ga.population_size ||
+        ga.local_search_steps < 0 || ga.local_search_rate < 0.0) {
+        throw std::invalid_argument("ga needs local_search_elites in [0, population_size] "
+                                    "and non-negative local_search_steps and rate");
+    }
+    const CMAESConfig& cmaes = cmaes_config;
+    if ((cmaes.population_size != 0 && cmaes.population_size < 2) ||
+        cmaes.max_generations < 1) {
+        throw std::invalid_argument("cmaes needs population_size 0 (automatic) or >= 2 "
+                                    "and max_generations >= 1");
+    }
+    if (cmaes.initial_sigma <= 0.0 || cmaes.initial_range < 0.0) {
+        throw std::invalid_argument("cmaes needs a positive initial_sigma and a "
+                                    "non-negative initial_range");
+    }
+    if (restart.min_gene_variance < 0.0 || restart.min_disagreement < 0.0 ||
+        restart.max_restarts < 0) {
+        throw std::invalid_argument("restart needs non-negative thresholds and max_restarts");
+    }
+    if (reduction.method != ReductionMethod::NONE &&
+        (reduction.components < 1 || reduction.components > dataset.getInputWidth() ||
+         reduction.mask_population < 4 || reduction.mask_generations < 0)) {
+        throw std::invalid_argument("reduction needs components in [1, " +
+                                    std::to_string(dataset.getInputWidth()) +
+                                    "], population >= 4 and generations >= 0");
+    }
+    const int width = inputWidth(dataset);
+    for (const auto& arch : architectures) {
+        if (arch.size() < 2 || arch.front() != width || arch.back() != 1) {
+            throw std::invalid_argument("architecture " + Utils::architectureName(arch) +
+                " must start with " + std::to_string(width) +
+                " inputs (the feature pipeline's or reduction's output width)"
+                " and end with 1 output");
+        }
+    }
+}
+
+void SweepSpec::print() const {
+    std::cout << "\nOptimizer: " << optimizerTypeName(optimizer_type) << "\n";
+    std::cout << "Fitness: " << fitnessTypeName(fitness_type) << "\n";
+    std::cout << "Activations:";
+    for (ActivationType act : activations) {
+        std::cout << " " << activationTypeName(act);
+    }
+    std::cout << "\nRuns: " << first_run << ".." << (first_run + num_runs - 1)
+              << ", folds: " << num_folds
+              << ", architectures: " << architectures.size() << "\n";
+    if (search.mode != SearchMode::GRID) {
+        std::cout << "Search: " << searchModeName(search.mode) << ", eta " << search.eta
+                  << ", min " << search.min_generations << " generations x "
+                  << search.min_runs << " runs\n";
+    }
+    if (!features.empty()) {
+        std::cout << "Features: " << features.describe() << "\n";
+    }
+    if (fold_normalization) {
+        std::cout << "Normalization: per fold, folded into the first layer\n";
+    }
+    if (reduction.method != ReductionMethod::NONE) {
+        std::cout << "Reduction: " << reductionMethodName(reduction.method) << " to "
+                  << reduction.components << " inputs per fold (fitted on the training fold)\n";
+    }
+    if (packed_evaluation) {
+        std::cout << "Evaluation: packed across the architectures of each run\n";
+    }
+    if (warm_start.enabled) {
+        std::cout << "Warm start: " << warm_start.elites << " elites per fold, "
+                  << (warm_start.random_fraction * 100) << "% random, perturbation "
+                  << warm_start.perturbation;
+        if (!warm_start.bank_file.empty()) {
+            std::cout << ", bank " << warm_start.bank_file;
+        }
+        std::cout << " (folds not independent)\n";
+    }
+    std::cout << "\nGA Configuration:\n";
+    std::cout << "  Population size: " << ga_config.population_size << "\n";
+    std::cout << "  Max generations: " << ga_config.max_generations << "\n";
+    std::cout << "  Crossover rate: " << ga_config.crossover_rate << "\n";
+    std::cout << "  Mutation rate: " << ga_config.mutation_rate << "\n";
+    std::cout << "  Mutation type: " << mutationTypeName(ga_config.mutation_type) << "\n";
+    std::cout << "  Elitism rate: " << ga_config.elitism_rate << "\n";
+    std::cout << "  Local search: " << ga_config.local_search_elites << " elites x "
+              << ga_config.local_search_steps << " gradient steps\n";
+    std::cout << "  Stop on: target fitness " << stopping.target_fitness
+              << ", stagnation " << stopping.stagnation_generations << " generations\n";
+    if (restart.min_gene_variance > 0.0 || restart.min_disagreement > 0.0) {
+        // A fresh stream: thresholds such as 1e-4 need the default float
+        // format, not the fixed precision std::cout may have been left in
+        std::ostringstream line;
+        line << "  Restart on: ";
+        if (restart.min_gene_variance > 0.0) {
+            line << "gene variance < " << restart.min_gene_variance;
+        }
+        if (restart.min_gene_variance > 0.0 && restart.min_disagreement > 0.0) {
+            line << " or ";
+        }
+        if (restart.min_disagreement > 0.0) {
+            line << "prediction disagreement < " << restart.min_disagreement;
+        }
+        line << " (at most " << restart.max_restarts << " restarts)\n";
+        std::cout << line.str();
+    }
+    std::cout << "\n";
+}
+
+SweepPlan SweepPlan::expand(const SweepSpec& spec, const Dataset& dataset) {
+    std::vector<Candidate> candidates;
+    for (const auto& arch : spec.architectures) {
+        for (ActivationType act : spec.activations) {
+            candidates.push_back({arch, act});
+        }
+    }
+    return expand(spec, dataset, candidates, spec.num_runs, 0);
+}
+
+SweepPlan SweepPlan::expand(const SweepSpec& spec, const Dataset& dataset,
+                            const std::vector<Candidate>& candidates,
+                            int num_runs, int max_generations) {
+    SweepPlan plan;
+    for (int r = 0; r < num_runs; r++) {
+        int run_id = spec.first_run + r;
+        unsigned int seed = spec.seedForRun(run_id);
+        plan.fold_plans.push_back(dataset.getFoldPlan(spec.num_folds, seed));
+
+        for (const Candidate& candidate : candidates) {
+            ExperimentJob job;
+            job.index = static_cast<int>(plan.experiments.size());
+            job.run_id = run_id;
+            job.seed = seed;
+            job.fold_plan = r;
+            job.architecture = candidate.architecture;
+            job.activation = candidate.activation;
+            job.max_generations = max_generations;
+
+            plan.experiments.push_back(job);
+        }
+        plan.run_end.push_back(static_cast<int>(plan.experiments.size()));
+    }
+    return plan;
+}
+
+SweepPlan SweepPlan::shard(const ShardSpec& shard) const {
+    SweepPlan part;
+    part.fold_plans = fold_plans;
+    int run_start = 0;
+    for (int end : run_end) {
+        for (int e = run_start; e < end; e++) {
+            if (shard.owns(experiments[e].index)) {
+                part.experiments.push_back(experiments[e]);
+            }
+        }
+        int size = static_cast<int>(part.experiments.size());
+        if (size > 0 && (part.run_end.empty() || part.run_end.back() != size)) {
+            part.run_end.push_back(size);
+        }
+        run_start = end;
+    }
+    return part;
+}
+
+std::string EliteBank::key(const std::vector<int>& architecture, ActivationType activation) {
+    return Utils::architectureName(architecture) + " " + activationTypeName(activation);
+}
+
+bool EliteBank::load(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string arch, activation;
+    int count, length;
+    while (file >> arch >> activation >> count >> length) {
+        std::vector<std::vector<double>> elites(count, std::vector<double>(length));
+        for (auto& chromosome : elites) {
+            for (double& gene : chromosome) {
+                if (!(file >> gene)) {
+                    throw std::runtime_error("Truncated elite bank " + filename);
+                }
+            }
+        }
+        entries[arch + " " + activation] = std::move(elites);
+    }
+    if (!file.eof()) {
+        throw std::runtime_error("Malformed elite bank " + filename);
+    }
+    return true;
+}
+
+void EliteBank::save(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot write elite bank " + filename);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    file << std::setprecision(17);
+    for (const auto& entry : entries) {
+        size_t length = entry.second.empty() ? 0 : entry.second[0].size();
+        file << entry.first << " " << entry.second.size() << " " << length << "\n";
+        for (const auto& chromosome : entry.second) {
+            for (size_t i = 0; i < chromosome.size(); i++) {
+                file << (i ? " " : "") << chromosome[i];
+            }
+            file << "\n";
+        }
+    }
+}
+
+std::vector<std::vector<double>> EliteBank::get(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    return it != entries.end() ? it->second : std::vector<std::vector<double>>();
+}
+
+void EliteBank::put(const std::string& key, std::vector<std::vector<double>> elites) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[key] = std::move(elites);
+}
+
+size_t EliteBank::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+SweepRunner::SweepRunner(const SweepSpec& sweep_spec, const Dataset& data,
+                         ThreadPool& thread_pool, ArenaPool& arena_pool)
+    : spec(sweep_spec), dataset(data), pool(thread_pool), arenas(arena_pool),
+      bank(nullptr) {}
+
+namespace {
+
+// Each fold draws from its own stream so jobs can run in any order
+unsigned int foldSeed(const ExperimentJob& job, int fold) {
+    unsigned int arch_seed = job.seed;
+    for (int width : job.architecture) {
+        arch_seed = Utils::combineSeed(arch_seed, width);
+    }
+    return Utils::combineSeed(arch_seed, fold);
+}
+
+// Train/test views of one fold, through the spec's input reduction when
+// it has one (fitted on the training rows, stored in reduced). The
+// reduction seed depends on the run and fold only, so every architecture
+// of a run sees the same reduced inputs. With fold normalization the
+// training-fold statistics are either applied ahead of the reduction or,
+// without one, returned in normalization for the MLPs to fold in lazily.
+// Off NUMA node 0 the node's own copies of the split and inputs are read
+// (the dataset's plan cache keeps them alive).
+void foldViews(const SweepSpec& spec, const Dataset& dataset, const ExperimentJob& job,
+               int fold, const FoldPlan& planned, int node, FeatureMatrix& reduced,
+               InputNormalization& normalization,
+               SampleView& train_view, SampleView& test_view, std::string& inputs) {
+    std::shared_ptr<const FoldPlan> local;
+    if (node > 0) {
+        local = dataset.getFoldPlan(planned.numFolds(), planned.getSeed(), node);
+    }
+    const FoldPlan& split = local ? *local : planned;
+
+    // Folds read the inputs through the plan's precomputed row indices
+    const std::vector<int>& train_rows = split.trainRows(fold);
+    const std::vector<int>& test_rows = split.testRows(fold);
+    if (spec.fold_normalization) {
+        normalization = InputNormalization::fit(dataset.view(train_rows, node));
+    }
+    if (spec.reduction.method == ReductionMethod::NONE) {
+        train_view = dataset.view(train_rows, node);
+        test_view = dataset.view(test_rows, node);
+        inputs = "all";
+        return;
+    }
+    InputReducer reducer(spec.reduction);
+    dataset.reduceInputs(reducer, train_rows, Utils::combineSeed(job.seed, fold),
+                         spec.fold_normalization ? &normalization : nullptr, reduced, node);
+    normalization = InputNormalization();
+    train_view = dataset.view(reduced, train_rows, node);
+    test_view = dataset.view(reduced, test_rows, node);
+    inputs = reducer.describe();
+}
+
+} // namespace
+
+std::unique_ptr<Optimizer> SweepRunner::makeOptimizer(const ExperimentJob& job, const MLP& mlp,
+                                                      const SampleView& train,
+                                                      const std::vector<std::vector<double>>& seeds,
+                                                      std::pmr::memory_resource* resource) const {
+    GAConfig ga_config = spec.ga_config;
+    CMAESConfig cmaes_config = spec.cmaes_config;
+    if (job.max_generations > 0) {
+        ga_config.max_generations = job.max_generations;
+        cmaes_config.max_generations = job.max_generations;
+    }
+    auto optimizer = createOptimizer(spec.optimizer_type, mlp.getChromosomeLength(),
+                                     ga_config, cmaes_config, resource);
+
+    optimizer->setFitnessFunction(createMLPFitnessFunction(mlp, train, spec.fitness_type));
+    optimizer->setBatchFitnessFunction(createMLPBatchFitnessFunction(mlp, train, spec.fitness_type));
+    if (spec.ga_config.local_search_elites > 0) {
+        optimizer->setLocalSearch(createMLPLocalSearch(
+            mlp, train, spec.ga_config.local_search_steps, spec.ga_config.local_search_rate));
+    }
+    optimizer->setStoppingCriteria(spec.stopping);
+    optimizer->setRestartCriteria(spec.restart);
+    // Prediction bitsets are only needed by the disagreement trigger
+    if (spec.restart.min_disagreement > 0) {
+        optimizer->setPhenotypeSamples(train.count);
+    }
+    if (!seeds.empty()) {
+        optimizer->setSeedChromosomes(seeds, spec.warm_start.random_fraction,
+                                      spec.warm_start.perturbation);
+    }
+    return optimizer;
+}
+
+FoldResult SweepRunner::scoreFold(int fold, MLP& mlp, const Optimizer& optimizer,
+                                  const SampleView& train, const SampleView& test,
+                                  bool seeded, double reference_fitness) const {
+    mlp.setWeights(optimizer.getBestIndividual().chromosome);
+
+    // One fused pass per set gives accuracy and the confusion matrix
+    auto train_metrics = mlp.evaluateMetrics(train);
+    auto test_metrics = mlp.evaluateMetrics(test);
+
+    FoldResult fold_result;
+    fold_result.fold_number = fold + 1;
+    fold_result.train_accuracy = train_metrics.accuracy;
+    fold_result.test_accuracy = test_metrics.accuracy;
+    fold_result.train_metrics = train_metrics;
+    fold_result.test_metrics = test_metrics;
+    fold_result.generations_used = optimizer.getGeneration();
+    fold_result.evaluations_used = optimizer.getEvaluations();
+    fold_result.stop_reason = stopReasonName(optimizer.getStopReason());
+    fold_result.best_fitness = optimizer.getBestFitness();
+    fold_result.initialization = !seeded ? "random"
+                               : fold == 0 ? "elite_bank" : "previous_fold";
+
+    // How soon this fold matched fold 0's final fitness (its own on fold 0)
+    double reference = reference_fitness < 0.0 ? fold_result.best_fitness : reference_fitness;
+    const auto& history = optimizer.getBestFitnessHistory();
+    fold_result.generations_to_reference = fold_result.generations_used;
+    for (size_t g = 0; g < history.size(); g++) {
+        if (history[g] >= reference) {
+            fold_result.generations_to_reference = static_cast<int>(g) + 1;
+            break;
+        }
+    }
+    SweepMetrics::global().folds_completed++;
+    return fold_result;
+}
+
+// Train and score one fold. Runs as a pool job: every temporary comes
+// from the worker's arena, which is rewound (not freed) between folds.
+FoldResult SweepRunner::runFold(const SweepPlan& plan, const ExperimentJob& job,
+                                int fold, FoldArena& arena, int node,
+                                const std::vector<std::vector<double>>& seeds,
+                                std::vector<std::vector<double>>* elites,
+                                double reference_fitness) const {
+    PROFILE_TAG(Utils::architectureName(job.architecture));
+    PROFILE_TRACE("fold");
+    arena.reset();
+    std::pmr::memory_resource* resource = arena.resource();
+    Utils::initRandom(foldSeed(job, fold));
+
+    FeatureMatrix reduced(resource);
+    InputNormalization normalization;
+    SampleView train_view, test_view;
+    std::string inputs;
+    foldViews(spec, dataset, job, fold, *plan.fold_plans[job.fold_plan], node, reduced,
+              normalization, train_view, test_view, inputs);
+
+    MLP mlp(job.architecture, job.activation, resource);
+    mlp.setInputNormalization(&normalization);
+    auto optimizer = makeOptimizer(job, mlp, train_view, seeds, resource);
+    optimizer->evolve();
+    if (elites) {
+        *elites = optimizer->getElites(spec.warm_start.elites);
+    }
+    FoldResult result = scoreFold(fold, mlp, *optimizer, train_view, test_view,
+                                  !seeds.empty(), reference_fitness);
+    result.inputs = inputs;
+    return result;
+}
+
+// The same fold for every experiment of a run (they share the split), with
+// the optimizers stepped in lockstep so each generation's populations are
+// scored by one packed evaluation. Each lane swaps its own thread RNG
+// state in around ask/tell, so the results match runFold bit for bit.
+std::vector<FoldResult> SweepRunner::runPackedFold(
+        const SweepPlan& plan, const std::vector<int>& experiments, int fold,
+        FoldArena& arena, int node, const std::vector<std::vector<std::vector<double>>>& seeds,
+        std::vector<std::vector<std::vector<double>>>* elites,
+        const std::vector<double>& reference_fitness) const {
+    PROFILE_TAG("packed");
+    PROFILE_TRACE("fold");
+    arena.reset();
+    std::pmr::memory_resource* resource = arena.resource();
+
+    const ExperimentJob& first = plan.experiments[experiments[0]];
+    FeatureMatrix reduced(resource);
+    InputNormalization normalization;
+    SampleView train_view, test_view;
+    std::string inputs;
+    foldViews(spec, dataset, first, fold, *plan.fold_plans[first.fold_plan], node, reduced,
+              normalization, train_view, test_view, inputs);
+
+    struct Lane {
+        std::unique_ptr<MLP> mlp;
+        std::unique_ptr<Optimizer> optimizer;
+        std::mt19937 rng;
+    };
+    std::vector<Lane> lanes(experiments.size());
+    for (size_t l = 0; l < lanes.size(); l++) {
+        const ExperimentJob& job = plan.experiments[experiments[l]];
+        Utils::initRandom(foldSeed(job, fold));
+        lanes[l].mlp.reset(new MLP(job.architecture, job.activation, resource));
+        lanes[l].mlp->setInputNormalization(&normalization);
+        lanes[l].optimizer = makeOptimizer(job, *lanes[l].mlp, train_view, seeds[l], resource);
+        lanes[l].optimizer->initialize();
+        lanes[l].rng = Utils::rng;
+    }
+
+    PackedMLPEvaluator evaluator;
+    std::vector<PackedMLPEvaluator::Lane> batch;
+    std::vector<EvaluationStats> stats;
+    std::vector<double> scores;
+    std::vector<uint64_t> predictions;
+    const int words = lanes.front().optimizer->predictionWords();    // 0 = not tracked
+    for (;;) {
+        // Ask every unfinished optimizer for its batch
+        batch.clear();
+        for (Lane& lane : lanes) {
+            if (lane.optimizer->isFinished()) continue;
+            Utils::rng = lane.rng;
+            const double* genes = lane.optimizer->ask();
+            lane.rng = Utils::rng;
+            const int length = lane.optimizer->getChromosomeLength();
+            for (int i = 0; i < lane.optimizer->batchSize(); i++) {
+                batch.push_back({lane.mlp.get(), genes + static_cast<size_t>(i) * length,
+                                 nullptr});
+            }
+        }
+        if (batch.empty()) break;
+        if (words > 0) {
+            predictions.resize(batch.size() * words);
+            for (size_t i = 0; i < batch.size(); i++) {
+                batch[i].predictions = predictions.data() + i * words;
+            }
+        }
+
+        PROFILE_PERF("optimizer.generation");
+        stats.resize(batch.size());
+        evaluator.evaluate(batch, train_view, spec.fitness_type, stats.data());
+
+        size_t next = 0;
+        for (Lane& lane : lanes) {
+            if (lane.optimizer->isFinished()) continue;
+            const int count = lane.optimizer->batchSize();
+            scores.resize(count);
+            const uint64_t* lane_predictions =
+                words > 0 ? predictions.data() + next * words : nullptr;
+            for (int i = 0; i < count; i++) {
+                scores[i] = stats[next++].fitness(spec.fitness_type);
+            }
+            Utils::rng = lane.rng;
+            lane.optimizer->tell(scores.data(), lane_predictions);
+            lane.rng = Utils::rng;
+        }
+    }
+
+    std::vector<FoldResult> results;
+    for (size_t l = 0; l < lanes.size(); l++) {
+        if (elites) {
+            (*elites)[l] = lanes[l].optimizer->getElites(spec.warm_start.elites);
+        }
+        results.push_back(scoreFold(fold, *lanes[l].mlp, *lanes[l].optimizer,
+                                    train_view, test_view,
+                                    !seeds[l].empty(), reference_fitness[l]));
+        results.back().inputs = inputs;
+    }
+    return results;
+}
+
+void SweepRunner::run(const SweepPlan& plan, ResultsManager& results_manager,
+                      bool write_checkpoints) {
+    const int num_experiments = static_cast<int>(plan.experiments.size());
+    const bool warm = spec.warm_start.enabled;
+
+    std::vector<ExperimentResult> pending(num_experiments);
+    std::vector<int> folds_left(num_experiments, spec.num_folds);
+    std::vector<std::vector<std::vector<double>>> final_elites(warm ? num_experiments : 0);
+    bool failed = false;    // a fold task threw
+    std::mutex mutex;
+    std::condition_variable experiment_done;
+
+    for (int e = 0; e < num_experiments; e++) {
+        const ExperimentJob& job = plan.experiments[e];
+        pending[e].network_structure = job.architecture;
+        pending[e].activation = activationTypeName(job.activation);
+        pending[e].run_id = job.run_id;
+        pending[e].seed = job.seed;
+        pending[e].fold_results.resize(spec.num_folds);
+        pending[e].warm_start = warm;
+        pending[e].plan_index = job.index;
+    }
+
+    // A fold task trains one fold of a group of experiments: each on its
+    // own, or a whole run together when packed
+    std::vector<std::vector<int>> groups;
+    if (spec.packed_evaluation) {
+        int run_start = 0;
+        for (int run_end : plan.run_end) {
+            groups.emplace_back();
+            for (int e = run_start; e < run_end; e++) {
+                groups.back().push_back(e);
+            }
+            run_start = run_end;
+        }
+    } else {
+        for (int e = 0; e < num_experiments; e++) {
+            groups.push_back({e});
+        }
+    }
+
+    // Each task only writes its own fold slots. A warm-started fold queues
+    // its successor with its elites, so a group's folds form a chain.
+    typedef std::vector<std::vector<double>> Elites;
+    std::function<void(int, int, std::vector<Elites>, std::vector<double>)> submit_fold;
+    submit_fold = [&](int g, int fold, std::vector<Elites> seeds, std::vector<double> references) {
+        pool.submit([&, g, fold, seeds = std::move(seeds),
+                     references = std::move(references)](int worker) {
+            try {
+                const std::vector<int>& group = groups[g];
+                std::vector<Elites> elites(group.size());
+                std::vector<FoldResult> results;
+                if (spec.packed_evaluation) {
+                    results = runPackedFold(plan, group, fold, arenas.forWorker(worker),
+                                            pool.nodeOf(worker), seeds,
+                                            warm ? &elites : nullptr, references);
+                } else {
+                    results.push_back(runFold(plan, plan.experiments[group[0]], fold,
+                                              arenas.forWorker(worker), pool.nodeOf(worker),
+                                              seeds[0], warm ? &elites[0] : nullptr,
+                                              references[0]));
+                }
+
+                const bool last_fold = fold + 1 == spec.num_folds;
+                if (warm && !last_fold) {
+                    std::vector<double> next_references(references);
+                    for (size_t l = 0; l < group.size(); l++) {
+                        if (next_references[l] < 0.0) {
+                            next_references[l] = results[l].best_fitness;
+                        }
+                    }
+                    submit_fold(g, fold + 1, std::move(elites), std::move(next_references));
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                for (size_t l = 0; l < group.size(); l++) {
+                    const int e = group[l];
+                    pending[e].fold_results[fold] = results[l];
+                    if (warm && last_fold) {
+                        final_elites[e] = std::move(elites[l]);
+                    }
+                    if (--folds_left[e] == 0) {
+                        experiment_done.notify_all();
+                    }
+                }
+            } catch (...) {
+                // Wake the commit loop; pool.wait() rethrows the exception
+                std::lock_guard<std::mutex> lock(mutex);
+                failed = true;
+                experiment_done.notify_all();
+                throw;
+            }
+        });
+    };
+
+    for (int g = 0; g < static_cast<int>(groups.size()); g++) {
+        const size_t size = groups[g].size();
+        std::vector<Elites> seeds(size);
+        if (warm && bank) {
+            for (size_t l = 0; l < size; l++) {
+                const ExperimentJob& job = plan.experiments[groups[g][l]];
+                MLP shape(job.architecture, job.activation);
+                seeds[l] = bank->get(EliteBank::key(job.architecture, job.activation));
+                if (!seeds[l].empty() &&
+                    static_cast<int>(seeds[l][0].size()) != shape.getChromosomeLength()) {
+                    seeds[l].clear();
+                }
+            }
+        }
+        // Warm-started groups start at fold 0 and chain the rest
+        for (int fold = 0; fold < (warm ? 1 : spec.num_folds); fold++) {
+            submit_fold(g, fold, seeds, std::vector<double>(size, -1.0));
+        }
+    }
+
+    // Commit experiments in plan order as they complete
+    auto start_time = std::chrono::steady_clock::now();
+    int run_index = 0;
+    for (int e = 0; e < num_experiments; e++) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            experiment_done.wait(lock, [&] { return failed || folds_left[e] == 0; });
+            if (failed) break;
+        }
+
+        ExperimentResult result = std::move(pending[e]);
+        result.calculate();
+        results_manager.addExperiment(result);
+        SweepMetrics::global().experiments_completed++;
+
+        int done = e + 1;
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now() - start_time).count();
+        int eta_seconds = static_cast<int>((double)elapsed / done * (num_experiments - done));
+
+        std::cout << "\rProgress: " << done << "/" << num_experiments
+                  << " (" << std::fixed << std::setprecision(1)
+                  << (100.0 * done / num_experiments) << "%)";
+        std::cout << " | Elapsed: " << (elapsed / 60) << "m " << (elapsed % 60) << "s";
+        std::cout << " | ETA: " << (eta_seconds / 60) << "m "
+                  << (eta_seconds % 60) << "s" << std::flush;
+
+        if (done == plan.run_end[run_index]) {
+            int run_id = plan.experiments[e].run_id;
+            run_index++;
+            if (write_checkpoints && spec.checkpoint_every > 0 &&
+                run_index % spec.checkpoint_every == 0) {
+                std::cout << "\n";
+                std::string checkpoint_file = "checkpoint_run_" +
+                                              std::to_string(run_id) + ".csv";
+                results_manager.saveAllResults(checkpoint_file);
+                std::cout << "Checkpoint saved: " << checkpoint_file << "\n";
+            }
+        }
+    }
+    std::cout << "\n";
+
+    // Rethrows a fold task's exception, keeping the committed experiments
+    pool.wait();
+
+    if (warm && bank) {
+        for (int e = 0; e < num_experiments; e++) {
+            const ExperimentJob& job = plan.experiments[e];
+            bank->put(EliteBank::key(job.architecture, job.activation),
+                      std::move(final_elites[e]));
+        }
+    }
+}
@@ -0,0 +1,155 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    int64_t clockNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    // The pool and worker index of the calling thread, if it is a worker
+    thread_local const ThreadPool* current_pool = nullptr;
+    thread_local int current_worker = -1;
+}
+
+ThreadPool::ThreadPool(int num_threads)
+    : ThreadPool(num_threads, NumaTopology()) {}
+
+ThreadPool::ThreadPool(int num_threads, const NumaTopology& numa_topology)
+    : topology(numa_topology), pinned(!numa_topology.node_cpus.empty()),
+      queued(0), next_node(0), cross_node_steals(0), pending(0), stopping(false) {
+    num_threads = std::max(1, num_threads);
+    tasks.resize(pinned ? topology.numNodes() : 1);
+    worker_node.assign(num_threads, 0);
+    if (pinned) {
+        for (int i = 0; i < num_threads; i++) {
+            worker_node[i] = topology.nodeForWorker(i);
+        }
+    }
+    busy_ns.reset(new std::atomic<int64_t>[num_threads]);
+    task_start.reset(new std::atomic<int64_t>[num_threads]);
+    for (int i = 0; i < num_threads; i++) {
+        busy_ns[i].store(0);
+        task_start[i].store(0);
+    }
+    workers.reserve(num_threads);
+    for (int i = 0; i < num_threads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop(int worker_id) {
+    current_pool = this;
+    current_worker = worker_id;
+    if (pinned) {
+        pinCurrentThread(topology.cpuForWorker(worker_id));
+    }
+    const int home = worker_node[worker_id];
+    const int nodes = numNodes();
+    
+    for (;;) {
+        std::function<void(int)> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_available.wait(lock, [this] { return stopping || queued > 0; });
+            if (queued == 0) {
+                return;
+            }
+            // Own node first, then the nearest other node with work
+            int node = home;
+            for (int d = 1; tasks[node].empty() && d < nodes; d++) {
+                node = (home + d) % nodes;
+            }
+            if (node != home) {
+                cross_node_steals.fetch_add(1, std::memory_order_relaxed);
+            }
+            task = std::move(tasks[node].front());
+            tasks[node].pop_front();
+            queued--;
+        }
+        
+        int64_t start = clockNanoseconds();
+        task_start[worker_id].store(start, std::memory_order_relaxed);
+        std::exception_ptr thrown;
+        try {
+            task(worker_id);
+        } catch (...) {
+            thrown = std::current_exception();
+        }
+        busy_ns[worker_id].fetch_add(clockNanoseconds() - start, std::memory_order_relaxed);
+        task_start[worker_id].store(0, std::memory_order_relaxed);
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (thrown && !error) {
+                // Keep the first failure and drop the work still queued
+                error = thrown;
+                for (auto& queue : tasks) {
+                    pending -= static_cast<int>(queue.size());
+                    queued -= static_cast<int>(queue.size());
+                    queue.clear();
+                }
+            }
+            if (--pending == 0) {
+                tasks_done.notify_all();
+            }
+        }
+    }
+}
+
+void ThreadPool::submit(std::function<void(int)> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error) {
+            return;    // a task failed; wait() is about to rethrow
+        }
+        int node = 0;
+        if (numNodes() > 1) {
+            node = current_pool == this ? worker_node[current_worker]
+                                        : next_node++ % numNodes();
+        }
+        tasks[node].push_back(std::move(task));
+        queued++;
+        pending++;
+    }
+    task_available.notify_one();
+}
+
+int ThreadPool::queueDepth() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queued;
+}
+
+int64_t ThreadPool::busyNanoseconds(int worker) const {
+    int64_t start = task_start[worker].load(std::memory_order_relaxed);
+    int64_t busy = busy_ns[worker].load(std::memory_order_relaxed);
+    return start > 0 ? busy + (clockNanoseconds() - start) : busy;
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    tasks_done.wait(lock, [this] { return pending == 0; });
+    if (error) {
+        std::exception_ptr thrown = error;
+        error = nullptr;
+        std::rethrow_exception(thrown);
+    }
+}
+
+
+int ThreadPool::defaultThreadCount() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n > 0 ? static_cast<int>(n) : 1;
+}
@@ -8,7 +8,7 @@
 
 namespace Utils {
 
-std::mt19937 rng;
+thread_local std::mt19937 rng;
 
 void initRandom(unsigned int seed) {
     if (seed == 0) {
@@ -18,6 +18,16 @@ void initRandom(unsigned int seed) {
     rng.seed(seed);
 }
 
+unsigned int combineSeed(unsigned int seed, unsigned int value) {
+    // SplitMix64 finalizer over both inputs
+    uint64_t z = (static_cast<uint64_t>(seed) << 32) ^ value;
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return static_cast<unsigned int>(z ^ (z >> 32));
+}
+
 double randomDouble(double min, double max) {
     std::uniform_real_distribution<double> dist(min, max);
     return dist(rng);
@@ -36,6 +46,154 @@ std::vector<double> randomVector(int size, double min, double max) {
     return vec;
 }
 
+std::string architectureName(const std::vector<int>& layers) {
+    std::string name;
+    for (size_t i = 0; i < layers.size(); i++) {
+        if (i > 0) name += "-";
+        name += std::to_string(layers[i]);
+    }
+    return name;
+}
+
+FastRandom::FastRandom(uint64_t value) {
+    seed(value);
+}
+
+void FastRandom::seed(uint64_t value) {
+    // SplitMix64 expansion of the seed into the 256-bit state
+    for (int i = 0; i < 4; i++) {
+        value += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = value;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        state[i] = z ^ (z >> 31);
+    }
+}
+
+void FastRandom::fillUniform(double* out, int n, double min, double max) {
+    const double scale = (max - min) * 0x1.0p-53;
+    for (int i = 0; i < n; i++) {
+        out[i] = min + static_cast<double>(next() >> 11) * scale;
+    }
+}
+
+void FastRandom::fillBits(uint8_t* mask, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t bits = next();
+        for (int b = 0; b < 8; b++) {
+            mask[i + b] = static_cast<uint8_t>((bits >> (b * 8)) & 1);
+        }
+    }
+    if (i < n) {
+        uint64_t bits = next();
+        for (int b = 0; i < n; i++, b++) {
+            mask[i] = static_cast<uint8_t>((bits >> (b * 8)) & 1);
+        }
+    }
+}
+
+namespace {
+
+// Ziggurat tables for the standard normal (Marsaglia & Tsang, 2000)
+struct ZigguratTables {
+    uint32_t kn[128];
+    double wn[128];
+    double fn[128];
+    
+    ZigguratTables() {
+        const double m1 = 2147483648.0;
+        const double vn = 9.91256303526217e-3;
+        double dn = 3.442619855899;
+        double tn = dn;
+        double q = vn / std::exp(-0.5 * dn * dn);
+        
+        kn[0] = static_cast<uint32_t>((dn / q) * m1);
+        kn[1] = 0;
+        wn[0] = q / m1;
+        wn[127] = dn / m1;
+        fn[0] = 1.0;
+        fn[127] = std::exp(-0.5 * dn * dn);
+        
+        for (int i = 126; i >= 1; i--) {
+            dn = std::sqrt(-2.0 * std::log(vn / dn + std::exp(-0.5 * dn * dn)));
+            kn[i + 1] = static_cast<uint32_t>((dn / tn) * m1);
+            tn = dn;
+            fn[i] = std::exp(-0.5 * dn * dn);
+            wn[i] = dn / m1;
+        }
+    }
+};
+
+const ZigguratTables& zigguratTables() {
+    static const ZigguratTables tables;
+    return tables;
+}
+
+uint32_t absoluteValue(int32_t x) {
+    return x < 0 ? 0u - static_cast<uint32_t>(x) : static_cast<uint32_t>(x);
+}
+
+} // namespace
+
+double FastRandom::nextGaussian() {
+    const ZigguratTables& z = zigguratTables();
+    int32_t hz = static_cast<int32_t>(next() >> 32);
+    int iz = hz & 127;
+    if (absoluteValue(hz) < z.kn[iz]) {
+        return hz * z.wn[iz];
+    }
+    return gaussianTail(hz, iz);
+}
+
+double FastRandom::gaussianTail(int32_t hz, int iz) {
+    const ZigguratTables& z = zigguratTables();
+    const double r = 3.442620;
+    
+    for (;;) {
+        double x = hz * z.wn[iz];
+        
+        // Base strip: sample from the tail beyond r
+        if (iz == 0) {
+            double y;
+            do {
+                x = -std::log(1.0 - nextDouble()) * 0.2904764;
+                y = -std::log(1.0 - nextDouble());
+            } while (y + y < x * x);
+            return hz > 0 ? r + x : -r - x;
+        }
+        
+        // Wedge: accept under the density curve
+        if (z.fn[iz] + nextDouble() * (z.fn[iz - 1] - z.fn[iz]) < std::exp(-0.5 * x * x)) {
+            return x;
+        }
+        
+        hz = static_cast<int32_t>(next() >> 32);
+        iz = hz & 127;
+        if (absoluteValue(hz) < z.kn[iz]) {
+            return hz * z.wn[iz];
+        }
+    }
+}
+
+void FastRandom::fillGaussian(double* out, int n, double mean, double stddev) {
+    for (int i = 0; i < n; i++) {
+        out[i] = mean + stddev * nextGaussian();
+    }
+}
+
+void FastRandom::fillCauchy(double* out, int n, double scale) {
+    const double pi = 3.14159265358979323846;
+    for (int i = 0; i < n; i++) {
+        out[i] = scale * std::tan(pi * (nextDouble() - 0.5));
+    }
+}
+
+FastRandom makeFastRandom() {
+    uint64_t seed = (static_cast<uint64_t>(rng()) << 32) | rng();
+    return FastRandom(seed);
+}
+
 std::vector<int> shuffleIndices(int size) {
     std::vector<int> indices(size);
     std::iota(indices.begin(), indices.end(), 0);